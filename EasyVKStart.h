@@ -6,6 +6,7 @@
 #include <vector>
 #include <stack>
 #include <map>
+#include <set>
 #include <unordered_map>
 #include <span>
 #include <memory>
@@ -15,6 +16,15 @@
 #include <chrono>
 #include <numeric>
 #include <numbers>
+#include <algorithm>
+#include <limits>
+#include <bit>
+#include <filesystem>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <deque>
 
 // GLM, 用于OpenGL的数学库，也适用于Vulkan
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -23,6 +33,10 @@
 #include <gtc/matrix_transform.hpp>
 
 // stb_image.h, 用于读取贴图，支持bmp、tga、png、jpeg、hdr等常见格式
+// 本项目只有main.cpp一个翻译单元, 故在此生成其实现
+#define STB_IMAGE_IMPLEMENTATION
+// textureStreamer在工作线程中解码, stbi_failure_reason()须为线程局部的
+#define STBI_THREAD_LOCAL thread_local
 #include <stb_image.h>
 
 // Vulkan
@@ -51,3 +65,465 @@ public:
     arrayRef& operator=(const arrayRef&) = delete;
 };
 #define ExecuteOnce(...) { static bool executed = false; if (executed) return __VA_ARGS__; executed = true; }
+
+// HDR风格的延迟直方图, 以对数分桶、桶内线性细分的方式记录以纳秒计的时长, 相对误差不超过1/subBucketCount
+// 记录操作为O(1)且不分配内存, 可在每帧中调用
+class latencyHistogram {
+    static constexpr uint32_t subBucketBits = 5;
+    static constexpr uint32_t subBucketCount = 1 << subBucketBits;
+    // 小于subBucketCount的值精确记录, 其余的值按最高位所在的位置分桶
+    static constexpr uint32_t bucketCount = 64 - subBucketBits + 1;
+    uint64_t counts[bucketCount * subBucketCount] = {};
+    uint64_t count = 0;
+    uint64_t min = UINT64_MAX;
+    uint64_t max = 0;
+    double total = 0;
+    //--------------------
+    static uint32_t Index(uint64_t value) {
+        if (value < subBucketCount)
+            return uint32_t(value);
+        uint32_t exponent = uint32_t(std::bit_width(value)) - 1;
+        uint32_t bucket = exponent - subBucketBits + 1;
+        return bucket * subBucketCount + uint32_t(value >> (exponent - subBucketBits)) - subBucketCount;
+    }
+    // 返回索引所对应区间的中点
+    static uint64_t Value(uint32_t index) {
+        if (index < subBucketCount)
+            return index;
+        uint32_t bucket = index / subBucketCount;
+        uint64_t lowerBound = uint64_t(index % subBucketCount + subBucketCount) << (bucket - 1);
+        return lowerBound + (uint64_t(1) << (bucket - 1) >> 1);
+    }
+public:
+    //Getter
+    uint64_t Count() const { return count; }
+    uint64_t Min() const { return count ? min : 0; }
+    uint64_t Max() const { return max; }
+    double Mean() const { return count ? total / count : 0; }
+    //Const Function
+    // percentile取值范围为[0, 100], 结果被限制在[Min(), Max()]之间
+    uint64_t Percentile(double percentile) const {
+        if (!count)
+            return 0;
+        uint64_t rank = uint64_t(percentile / 100 * double(count - 1)) + 1;
+        if (rank >= count)
+            return max;
+        uint64_t accumulated = 0;
+        for (uint32_t i = 0; i < bucketCount * subBucketCount; i++)
+            if ((accumulated += counts[i]) >= rank)
+                return std::clamp(Value(i), min, max);
+        return max;
+    }
+    //Non-const Function
+    void Record(uint64_t nanoseconds) {
+        counts[Index(nanoseconds)]++;
+        count++;
+        min = std::min(min, nanoseconds);
+        max = std::max(max, nanoseconds);
+        total += double(nanoseconds);
+    }
+    void Reset() {
+        *this = latencyHistogram();
+    }
+};
+
+// 渲染循环的分阶段计时, 每个阶段各有一个直方图, 以便得到p50/p95/p99/max等尾部延迟, 而非仅有平均帧率
+class frameInstrumentation {
+public:
+    enum phase : uint32_t {
+        phase_fenceWait,
+        phase_acquire,
+        phase_record,
+        phase_submit,
+        phase_present,
+        // 整帧, 即相邻两次BeginFrame()的间隔
+        phase_frame,
+        phaseCount
+    };
+    static constexpr const char* phaseNames[phaseCount] = { "fenceWait", "acquire", "record", "submit", "present", "frame" };
+    enum dumpFormat : uint32_t {
+        dumpFormat_csv,
+        // 每次输出一行JSON（JSON Lines）
+        dumpFormat_json
+    };
+    // 构造时记下起始时刻, 析构时将经过的时长记录到对应阶段
+    class scope {
+        frameInstrumentation& instrumentation;
+        frameInstrumentation::phase phase;
+        std::chrono::steady_clock::time_point time0 = std::chrono::steady_clock::now();
+    public:
+        scope(frameInstrumentation& instrumentation, enum phase phase) :instrumentation(instrumentation), phase(phase) {}
+        scope(scope&&) = delete;
+        ~scope() { instrumentation.Record(phase, std::chrono::steady_clock::now() - time0); }
+    };
+private:
+    latencyHistogram histograms[phaseCount];
+    uint64_t frameCount = 0;
+    std::chrono::steady_clock::time_point time_start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point time_frameBegin;
+    // 周期性输出
+    std::string dumpPath;
+    dumpFormat format = dumpFormat_csv;
+    std::chrono::steady_clock::duration dumpInterval{};
+    std::chrono::steady_clock::time_point time_lastDump;
+    bool resetAfterDump = true;
+public:
+    //Getter
+    const latencyHistogram& Histogram(phase phase) const {
+        return histograms[phase];
+    }
+    // BeginFrame()被调用的总次数, 不随Reset()清零
+    uint64_t FrameCount() const {
+        return frameCount;
+    }
+    //Const Function
+    // 以表格形式输出各阶段的统计结果, 单位为毫秒
+    std::string Report() const {
+        std::string report = std::format("{:<12}{:>10}{:>10}{:>10}{:>10}{:>10}{:>10}\n", "CPU (ms)", "count", "mean", "p50", "p95", "p99", "max");
+        for (uint32_t i = 0; i < phaseCount; i++) {
+            auto& h = histograms[i];
+            report += std::format("{:<12}{:>10}{:>10.3f}{:>10.3f}{:>10.3f}{:>10.3f}{:>10.3f}\n", phaseNames[i], h.Count(),
+                h.Mean() * 1e-6, h.Percentile(50) * 1e-6, h.Percentile(95) * 1e-6, h.Percentile(99) * 1e-6, h.Max() * 1e-6);
+        }
+        return report;
+    }
+    // 将当前统计结果追加到文件, CSV文件为空时先写入表头
+    bool Dump(const char* filepath, dumpFormat format = dumpFormat_csv) const {
+        // 仅以app打开时首次写入前tellp()为0, 加上ate使其为文件末尾, 以判断文件是否为空
+        std::ofstream file(filepath, std::ios::app | std::ios::ate);
+        if (!file) {
+            std::cout << std::format("[ frameInstrumentation ] ERROR\nFailed to open the file: {}\n", filepath);
+            return false;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - time_start).count();
+        if (format == dumpFormat_csv) {
+            if (!file.tellp())
+                file << "time_s,phase,count,mean_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+            for (uint32_t i = 0; i < phaseCount; i++) {
+                auto& h = histograms[i];
+                file << std::format("{:.3f},{},{},{:.4f},{:.4f},{:.4f},{:.4f},{:.4f}\n", seconds, phaseNames[i], h.Count(),
+                    h.Mean() * 1e-6, h.Percentile(50) * 1e-6, h.Percentile(95) * 1e-6, h.Percentile(99) * 1e-6, h.Max() * 1e-6);
+            }
+        }
+        else {
+            file << std::format("{{\"time_s\":{:.3f},\"frames\":{},\"phases\":{{", seconds, frameCount);
+            for (uint32_t i = 0; i < phaseCount; i++) {
+                auto& h = histograms[i];
+                file << std::format("{}\"{}\":{{\"count\":{},\"mean_ms\":{:.4f},\"p50_ms\":{:.4f},\"p95_ms\":{:.4f},\"p99_ms\":{:.4f},\"max_ms\":{:.4f}}}",
+                    i ? "," : "", phaseNames[i], h.Count(),
+                    h.Mean() * 1e-6, h.Percentile(50) * 1e-6, h.Percentile(95) * 1e-6, h.Percentile(99) * 1e-6, h.Max() * 1e-6);
+            }
+            file << "}}\n";
+        }
+        return true;
+    }
+    //Non-const Function
+    // 在每帧开始时调用, 记录整帧的时长, 并在需要时周期性地输出统计结果
+    void BeginFrame() {
+        auto now = std::chrono::steady_clock::now();
+        if (frameCount++)
+            Record(phase_frame, now - time_frameBegin);
+        time_frameBegin = now;
+        if (dumpPath.size() &&
+            now - time_lastDump >= dumpInterval) {
+            Dump(dumpPath.c_str(), format);
+            time_lastDump = now;
+            if (resetAfterDump)
+                Reset();
+        }
+    }
+    void Record(phase phase, std::chrono::steady_clock::duration duration) {
+        histograms[phase].Record(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()));
+    }
+    scope Measure(phase phase) {
+        return scope(*this, phase);
+    }
+    // 每隔interval将统计结果追加到filepath, resetAfterDump为true时每次输出后清空直方图, 使每行只反映该时间段
+    void EnablePeriodicDump(const char* filepath, std::chrono::steady_clock::duration interval, dumpFormat format = dumpFormat_csv, bool resetAfterDump = true) {
+        dumpPath = filepath;
+        dumpInterval = interval;
+        this->format = format;
+        this->resetAfterDump = resetAfterDump;
+        time_lastDump = std::chrono::steady_clock::now();
+    }
+    void DisablePeriodicDump() {
+        dumpPath.clear();
+    }
+    // 清空各直方图
+    void Reset() {
+        for (auto& i : histograms)
+            i.Reset();
+    }
+};
+
+// 工作窃取（work stealing）的任务调度器, 每个工作线程有自己的无锁双端队列, 从底部压入和取出任务, 空闲时从其他工作线程的队列顶部窃取
+// 非工作线程提交的任务进入共享队列; 须在主线程（创建调度器的线程, 如GLFW的线程）中执行的任务另行排队, 由主线程在ExecuteMainThreadJobs()或Wait(...)中执行
+class jobSystem {
+    struct job;
+public:
+    // 任务计数器, 以其提交的任务在完成时将其减1, 归零后调度以其为依赖的任务
+    class counter {
+        friend class jobSystem;
+        uint32_t value = 0;
+        // 减少计数与判断是否归零均须加锁, 使Wait(...)返回后计数器可被立即销毁
+        mutable std::mutex mutex;
+        std::vector<job*> continuations;
+    public:
+        counter() = default;
+        counter(counter&&) = delete;
+        bool IsDone() const {
+            std::lock_guard lock(mutex);
+            return !value;
+        }
+    };
+private:
+    struct job {
+        std::function<void()> function;
+        counter* pCounter;
+        bool mainThread;
+    };
+    // Chase-Lev双端队列, Push和Pop只能由所有者线程调用, Steal可由任意线程调用, 容量固定, 满时由调用者改用共享队列
+    class workStealingDeque {
+        static constexpr int64_t capacity = 4096;
+        std::atomic<int64_t> top = 0;
+        std::atomic<int64_t> bottom = 0;
+        std::atomic<job*> jobs[capacity] = {};
+    public:
+        bool Push(job* pJob) {
+            int64_t b = bottom.load(std::memory_order_relaxed);
+            int64_t t = top.load(std::memory_order_acquire);
+            if (b - t >= capacity)
+                return false;
+            jobs[b & (capacity - 1)].store(pJob, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return true;
+        }
+        job* Pop() {
+            int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t t = top.load(std::memory_order_relaxed);
+            if (t > b) {
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            job* pJob = jobs[b & (capacity - 1)].load(std::memory_order_relaxed);
+            // 只剩最后一个任务时, 与窃取者竞争
+            if (t == b) {
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    pJob = nullptr;
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+            return pJob;
+        }
+        job* Steal() {
+            int64_t t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t b = bottom.load(std::memory_order_acquire);
+            if (t >= b)
+                return nullptr;
+            job* pJob = jobs[t & (capacity - 1)].load(std::memory_order_relaxed);
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr;
+            return pJob;
+        }
+    };
+    std::vector<std::unique_ptr<workStealingDeque>> deques;
+    std::vector<std::thread> workers;
+    std::thread::id mainThreadId;
+    // 以下队列由mutex保护, condition用于使空闲的工作线程休眠
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<job*> sharedJobs;
+    std::deque<job*> mainThreadJobs;
+    // 已入队且尚未被取出的任务数（不含须在主线程中执行的任务）
+    std::atomic<uint32_t> queuedCount = 0;
+    bool stopping = false;
+    // 当前线程所属的调度器及其工作线程索引（从1开始）, 非工作线程为nullptr和0
+    inline static thread_local jobSystem* pCurrentJobSystem = nullptr;
+    inline static thread_local uint32_t currentWorkerIndex = 0;
+    //--------------------
+    void Schedule_Internal(job* pJob) {
+        if (pJob->mainThread) {
+            std::lock_guard lock(mutex);
+            mainThreadJobs.push_back(pJob);
+            return;
+        }
+        queuedCount.fetch_add(1, std::memory_order_release);
+        bool pushed = pCurrentJobSystem == this && deques[currentWorkerIndex - 1]->Push(pJob);
+        {
+            // 压入本线程的队列时也加锁, 以免工作线程在检查条件与开始等待之间错过通知
+            std::lock_guard lock(mutex);
+            if (!pushed)
+                sharedJobs.push_back(pJob);
+        }
+        condition.notify_one();
+    }
+    // workerIndex为0时不从自己的队列中取任务
+    job* Next_Internal(uint32_t workerIndex) {
+        if (!queuedCount.load(std::memory_order_acquire))
+            return nullptr;
+        job* pJob = workerIndex ? deques[workerIndex - 1]->Pop() : nullptr;
+        if (!pJob) {
+            std::lock_guard lock(mutex);
+            if (sharedJobs.size())
+                pJob = sharedJobs.front(),
+                sharedJobs.pop_front();
+        }
+        // 从下一个工作线程起依次窃取, 跳过自己的队列
+        for (size_t i = 0; !pJob && i < deques.size(); i++)
+            if (size_t victim = (workerIndex + i) % deques.size(); victim + 1 != workerIndex)
+                pJob = deques[victim]->Steal();
+        if (pJob)
+            queuedCount.fetch_sub(1, std::memory_order_relaxed);
+        return pJob;
+    }
+    void Execute_Internal(job* pJob) {
+        pJob->function();
+        if (counter* pCounter = pJob->pCounter) {
+            std::vector<job*> continuations;
+            {
+                std::lock_guard lock(pCounter->mutex);
+                if (!--pCounter->value)
+                    continuations.swap(pCounter->continuations);
+            }
+            for (job* i : continuations)
+                Schedule_Internal(i);
+        }
+        delete pJob;
+    }
+    void Worker_Internal(uint32_t workerIndex) {
+        pCurrentJobSystem = this;
+        currentWorkerIndex = workerIndex;
+        while (true) {
+            if (job* pJob = Next_Internal(workerIndex)) {
+                Execute_Internal(pJob);
+                continue;
+            }
+            std::unique_lock lock(mutex);
+            condition.wait(lock, [this] { return stopping || queuedCount.load(std::memory_order_acquire); });
+            if (stopping)
+                return;
+        }
+    }
+    job* CreateJob_Internal(std::function<void()>&& function, counter* pCounter, bool mainThread) {
+        if (pCounter) {
+            std::lock_guard lock(pCounter->mutex);
+            pCounter->value++;
+        }
+        return new job{ std::move(function), pCounter, mainThread };
+    }
+public:
+    // workerCount为0时使用硬件线程数减1（至少为1）个工作线程, 创建调度器的线程被视作主线程
+    jobSystem(uint32_t workerCount = 0) {
+        if (!workerCount)
+            workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+        mainThreadId = std::this_thread::get_id();
+        for (uint32_t i = 0; i < workerCount; i++)
+            deques.push_back(std::make_unique<workStealingDeque>());
+        for (uint32_t i = 0; i < workerCount; i++)
+            workers.emplace_back(&jobSystem::Worker_Internal, this, i + 1);
+    }
+    jobSystem(jobSystem&&) = delete;
+    ~jobSystem() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+        for (auto& i : workers)
+            i.join();
+        for (job* i : sharedJobs)
+            delete i;
+        for (job* i : mainThreadJobs)
+            delete i;
+        for (auto& i : deques)
+            while (job* pJob = i->Steal())
+                delete pJob;
+    }
+    //Getter
+    uint32_t WorkerCount() const {
+        return uint32_t(workers.size());
+    }
+    // 包括主线程在内的线程数
+    uint32_t ThreadCount() const {
+        return uint32_t(workers.size()) + 1;
+    }
+    // 当前线程的索引, 工作线程为[1, WorkerCount()], 其他线程（包括主线程）为0, 可用于索引逐线程的资源
+    uint32_t CurrentThreadIndex() const {
+        return pCurrentJobSystem == this ? currentWorkerIndex : 0;
+    }
+    bool IsMainThread() const {
+        return std::this_thread::get_id() == mainThreadId;
+    }
+    //Non-const Function
+    // 提交任务, pCounter非空时在提交时将其加1, 任务完成后减1
+    void Run(std::function<void()> function, counter* pCounter = nullptr) {
+        Schedule_Internal(CreateJob_Internal(std::move(function), pCounter, false));
+    }
+    // 在dependency归零后提交任务
+    void RunAfter(counter& dependency, std::function<void()> function, counter* pCounter = nullptr) {
+        job* pJob = CreateJob_Internal(std::move(function), pCounter, false);
+        {
+            std::lock_guard lock(dependency.mutex);
+            if (dependency.value) {
+                dependency.continuations.push_back(pJob);
+                return;
+            }
+        }
+        Schedule_Internal(pJob);
+    }
+    // 提交须在主线程中执行的任务（如调用GLFW的函数）
+    void RunOnMainThread(std::function<void()> function, counter* pCounter = nullptr) {
+        Schedule_Internal(CreateJob_Internal(std::move(function), pCounter, true));
+    }
+    // 将[0, count)以grainSize为粒度分为若干段, 各段作为一个任务调用function(begin, end)
+    template<typename F>
+    void ParallelFor(uint32_t count, uint32_t grainSize, F function, counter& done) {
+        grainSize = std::max(grainSize, 1u);
+        for (uint32_t begin = 0; begin < count; begin += grainSize)
+            Run([function, begin, end = std::min(begin + grainSize, count)] { function(begin, end); }, &done);
+    }
+    // 同上, 但等待所有段完成后返回
+    template<typename F>
+    void ParallelFor(uint32_t count, uint32_t grainSize, F function) {
+        jobSystem::counter done;
+        ParallelFor(count, grainSize, std::move(function), done);
+        Wait(done);
+    }
+    // 执行所有已提交的须在主线程中执行的任务, 返回执行的任务数, 须在主线程中调用（如在每帧的开头）
+    uint32_t ExecuteMainThreadJobs() {
+        uint32_t executedCount = 0;
+        while (true) {
+            job* pJob = nullptr;
+            {
+                std::lock_guard lock(mutex);
+                if (mainThreadJobs.empty())
+                    return executedCount;
+                pJob = mainThreadJobs.front();
+                mainThreadJobs.pop_front();
+            }
+            Execute_Internal(pJob);
+            executedCount++;
+        }
+    }
+    // 等待counter归零, 等待期间当前线程亦执行任务, 在主线程中调用时包括须在主线程中执行的任务
+    void Wait(const counter& done) {
+        bool mainThread = IsMainThread();
+        while (!done.IsDone()) {
+            if (mainThread && ExecuteMainThreadJobs())
+                continue;
+            if (job* pJob = Next_Internal(CurrentThreadIndex()))
+                Execute_Internal(pJob);
+            else
+                std::this_thread::yield();
+        }
+    }
+    //Static Function
+    // 引擎各部分共用的调度器, 在首次调用时创建, 首次调用的线程被视作主线程
+    static jobSystem& Default() {
+        static jobSystem instance;
+        return instance;
+    }
+};
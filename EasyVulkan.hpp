@@ -23,7 +23,7 @@ namespace easyVulkan {
                 .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
                 .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
                 .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED, // 将initialLayout设定为VK_IMAGE_LAYOUT_UNDEFINED可能导致丢弃图像附件原有的内容，但鉴于会在渲染循环中每帧清空图像，因此无妨
-                .finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR // 以便将交换链图像用于呈现
+                .finalLayout = graphicsBase::Base().PresentLayout() // 以便将交换链图像用于呈现（未开启交换链扩展的离屏渲染则为VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL）
             };
 
             VkAttachmentReference attachmentReference = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
@@ -75,7 +75,10 @@ namespace easyVulkan {
                 }
                 };
             auto DestroyFramebuffers = [] {
-                rpwf_screen.framebuffers.clear(); // 清空vector中的元素时会逐一调用析构函数
+                // 帧缓冲可能仍被先前的帧所使用, 延迟到这些帧执行完毕后销毁
+                for (auto& i : rpwf_screen.framebuffers)
+                    i.DeferDestroy();
+                rpwf_screen.framebuffers.clear();
                 };
             graphicsBase::Base().PushCallback_CreateSwapchain(CreateFramebuffers);
             graphicsBase::Base().PushCallback_DestroySwapchain(DestroyFramebuffers);
@@ -85,4 +88,444 @@ namespace easyVulkan {
         }
         return rpwf_screen;
     }
+
+    // 创建一个渲染到交换链图像并做深度测试的渲染通道, 及其对应的帧缓冲
+    // 深度附件只在渲染通道内使用, 以瞬态附件创建, 由attachmentPool在交换链重建时一并重建
+    const auto& CreateRpwf_ScreenWithDepth() {
+        static renderPassWithFramebuffers rpwf_screenWithDepth;
+        static attachmentPool attachments;
+        static uint32_t depthAttachmentIndex;
+        if (rpwf_screenWithDepth.renderPass)
+            outStream << std::format("[ easyVulkan ] WARNING\nDon't call CreateRpwf_ScreenWithDepth() twice!\n");
+        else {
+            // 选取首个支持用作深度附件的格式
+            VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+            for (VkFormat i : { VK_FORMAT_D32_SFLOAT, VK_FORMAT_X8_D24_UNORM_PACK32, VK_FORMAT_D24_UNORM_S8_UINT, VK_FORMAT_D16_UNORM }) {
+                VkFormatProperties formatProperties;
+                vkGetPhysicalDeviceFormatProperties(graphicsBase::Base().PhysicalDevice(), i, &formatProperties);
+                if (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT) {
+                    depthFormat = i;
+                    break;
+                }
+            }
+            // 无可用格式时不创建, 返回的renderPass为空
+            if (!depthFormat) {
+                outStream << std::format("[ easyVulkan ] ERROR\nNo supported depth format for CreateRpwf_ScreenWithDepth()!\n");
+                return rpwf_screenWithDepth;
+            }
+            depthAttachmentIndex = attachments.Add({
+                .format = depthFormat,
+                .usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT
+            });
+
+            VkAttachmentDescription attachmentDescriptions[2] = {
+                {
+                    .format = graphicsBase::Base().SwapchainCreateInfo().imageFormat,
+                    .samples = VK_SAMPLE_COUNT_1_BIT,
+                    .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+                    .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+                    .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+                    .finalLayout = graphicsBase::Base().PresentLayout() },
+                {
+                    // 深度值在渲染通道结束后不再需要, 不写回内存
+                    .format = depthFormat,
+                    .samples = VK_SAMPLE_COUNT_1_BIT,
+                    .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+                    .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+                    .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+                    .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+                    .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+                    .finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL }
+            };
+            VkAttachmentReference attachmentReferences[2] = {
+                { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL },
+                { 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL }
+            };
+            VkSubpassDescription subpassDescription = {
+                .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+                .colorAttachmentCount = 1,
+                .pColorAttachments = attachmentReferences,
+                .pDepthStencilAttachment = attachmentReferences + 1
+            };
+            // 深度附件在各帧间被重用, 须等待先前的帧的深度测试完成后再清空
+            VkSubpassDependency subpassDependency = {
+                .srcSubpass = VK_SUBPASS_EXTERNAL,
+                .dstSubpass = 0,
+                .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+                .srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                .dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT
+            };
+            VkRenderPassCreateInfo renderPassCreateInfo = {
+                .attachmentCount = 2,
+                .pAttachments = attachmentDescriptions,
+                .subpassCount = 1,
+                .pSubpasses = &subpassDescription,
+                .dependencyCount = 1,
+                .pDependencies = &subpassDependency
+            };
+            rpwf_screenWithDepth.renderPass.Create(renderPassCreateInfo);
+
+            auto CreateFramebuffers = [] {
+                attachments.Create(windowSize);
+                rpwf_screenWithDepth.framebuffers.resize(graphicsBase::Base().SwapchainImageCount());
+                VkFramebufferCreateInfo framebufferCreateInfo = {
+                    .renderPass = rpwf_screenWithDepth.renderPass,
+                    .attachmentCount = 2,
+                    .width = windowSize.width,
+                    .height = windowSize.height,
+                    .layers = 1
+                };
+                for (size_t i = 0; i < graphicsBase::Base().SwapchainImageCount(); i++) {
+                    VkImageView attachmentViews[2] = { graphicsBase::Base().SwapchainImageView(i), attachments.ImageView(depthAttachmentIndex) };
+                    framebufferCreateInfo.pAttachments = attachmentViews;
+                    rpwf_screenWithDepth.framebuffers[i].Create(framebufferCreateInfo);
+                }
+                };
+            auto DestroyFramebuffers = [] {
+                for (auto& i : rpwf_screenWithDepth.framebuffers)
+                    i.DeferDestroy();
+                rpwf_screenWithDepth.framebuffers.clear();
+                attachments.Destroy();
+                };
+            graphicsBase::Base().PushCallback_CreateSwapchain(CreateFramebuffers);
+            graphicsBase::Base().PushCallback_DestroySwapchain(DestroyFramebuffers);
+
+            // 首次初始化需要手动调用一次
+            CreateFramebuffers();
+        }
+        return rpwf_screenWithDepth;
+    }
+
+    // 动态渲染（Vulkan1.3或VK_KHR_dynamic_rendering）的附件信息, 直接以image view为附件, 无需渲染通道和帧缓冲
+    VkRenderingAttachmentInfo RenderingAttachment(VkImageView imageView, VkImageLayout imageLayout,
+        VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR, VkAttachmentStoreOp storeOp = VK_ATTACHMENT_STORE_OP_STORE, VkClearValue clearValue = {}) {
+        return {
+            .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+            .imageView = imageView,
+            .imageLayout = imageLayout,
+            .loadOp = loadOp,
+            .storeOp = storeOp,
+            .clearValue = clearValue
+        };
+    }
+
+    // 以动态渲染开始渲染, 附件的布局转换不在此进行, 须事先以屏障将各附件转到其imageLayout
+    void CmdBeginRendering(VkCommandBuffer commandBuffer, VkRect2D renderArea, arrayRef<const VkRenderingAttachmentInfo> colorAttachments,
+        const VkRenderingAttachmentInfo* pDepthAttachment = nullptr, const VkRenderingAttachmentInfo* pStencilAttachment = nullptr,
+        uint32_t layerCount = 1, VkRenderingFlags flags = 0) {
+        if (!graphicsBase::Base().CmdBeginRendering()) {
+            outStream << std::format("[ easyVulkan ] ERROR\nDynamic rendering is not supported by the device!\n");
+            return;
+        }
+        VkRenderingInfo renderingInfo = {
+            .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+            .flags = flags,
+            .renderArea = renderArea,
+            .layerCount = layerCount,
+            .colorAttachmentCount = uint32_t(colorAttachments.Count()),
+            .pColorAttachments = colorAttachments.Pointer(),
+            .pDepthAttachment = pDepthAttachment,
+            .pStencilAttachment = pStencilAttachment
+        };
+        graphicsBase::Base().CmdBeginRendering()(commandBuffer, &renderingInfo);
+    }
+    void CmdEndRendering(VkCommandBuffer commandBuffer) {
+        if (graphicsBase::Base().CmdEndRendering())
+            graphicsBase::Base().CmdEndRendering()(commandBuffer);
+    }
+
+    // 以动态渲染直接渲染到SwapchainImageView(imageIndex), 对应CreateRpwf_Screen()的渲染通道, 但交换链重建时无需重建帧缓冲
+    // 开始前将交换链图像从VK_IMAGE_LAYOUT_UNDEFINED转到VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL（图像内容被丢弃, 因此loadOp不应为VK_ATTACHMENT_LOAD_OP_LOAD）
+    void CmdBeginRendering_Screen(VkCommandBuffer commandBuffer, uint32_t imageIndex, const VkClearColorValue& clearColor = {}) {
+        // 与CreateRpwf_Screen()中的子通道依赖相同, 等待呈现引擎读取完毕（获取图像的信号量在该阶段被等待）
+        VkImageMemoryBarrier imageMemoryBarrier = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask = 0,
+            .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = graphicsBase::Base().SwapchainImage(imageIndex),
+            .subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
+        };
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0,
+            0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+        VkRenderingAttachmentInfo colorAttachment = RenderingAttachment(graphicsBase::Base().SwapchainImageView(imageIndex), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE, { .color = clearColor });
+        CmdBeginRendering(commandBuffer, { {}, windowSize }, colorAttachment);
+    }
+    // 结束渲染并将交换链图像转到PresentLayout(), 相当于渲染通道的finalLayout
+    void CmdEndRendering_Screen(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
+        CmdEndRendering(commandBuffer);
+        // 呈现由信号量同步, 因此dstStageMask为VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT且dstAccessMask为0
+        VkImageMemoryBarrier imageMemoryBarrier = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+            .dstAccessMask = 0,
+            .oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            .newLayout = graphicsBase::Base().PresentLayout(),
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = graphicsBase::Base().SwapchainImage(imageIndex),
+            .subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
+        };
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+            0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+    }
+
+    // 从filepath读取管线缓存并将其设为默认管线缓存, 销毁逻辑设备前或程序退出时将其写回文件, 重建逻辑设备后重新读取
+    // 各工作线程可各自创建管线缓存, 完成后通过返回值的Merge(...)合并到该缓存中
+    const vulkan::pipelineCache& UsePersistentPipelineCache(const char* filepath) {
+        // 函数内的静态对象先于graphicsBase的单例被析构, 因此程序退出时在此写回, 而非依赖销毁逻辑设备时的回调函数
+        static struct persistentPipelineCache {
+            vulkan::pipelineCache pipelineCache;
+            std::string path;
+            ~persistentPipelineCache() {
+                Save();
+            }
+            void Save() {
+                if (!pipelineCache)
+                    return;
+                graphicsBase::Base().PipelineCache(VK_NULL_HANDLE);
+                pipelineCache.Save(path.c_str());
+                pipelineCache.~pipelineCache();
+            }
+        } cache;
+        if (cache.pipelineCache) {
+            outStream << std::format("[ easyVulkan ] WARNING\nDon't call UsePersistentPipelineCache(...) twice!\n");
+            return cache.pipelineCache;
+        }
+        cache.path = filepath;
+        auto Create = [] {
+            cache.pipelineCache.Create(cache.path.c_str());
+            graphicsBase::Base().PipelineCache(cache.pipelineCache);
+            };
+        auto Destroy = [] {
+            cache.Save();
+            };
+        graphicsBase::Base().PushCallback_CreateDevice(Create);
+        graphicsBase::Base().PushCallback_DestroyDevice(Destroy);
+
+        // 首次初始化需要手动调用一次
+        Create();
+        return cache.pipelineCache;
+    }
+
+    // 即时帧（frames in flight）的帧上下文环, 每个槽位持有一套专用的同步对象和命令缓冲区, 使CPU录制当前帧时GPU仍可执行先前的帧
+    template<uint32_t maxFramesInFlight>
+    class frameContext {
+        static_assert(maxFramesInFlight > 0, "frameContext needs at least one frame slot!");
+    public:
+        struct frame {
+            // 以置位状态初始化, 在该槽位的命令执行完后被置位, 重用该槽位前需在CPU一侧等待
+            vulkan::fence fence{ VK_FENCE_CREATE_SIGNALED_BIT };
+            vulkan::semaphore semaphore_imageIsAvailable;
+            vulkan::semaphore semaphore_renderingIsOver;
+            // 瞬态命令池, 在该槽位的栅栏被等待后整体重置, 除commandBuffer外, 该帧所需的其他命令缓冲区可由commandPool.Next(...)依次取得
+            vulkan::linearCommandPool commandPool{ graphicsBase::Base().QueueFamilyIndex_Graphics() };
+            vulkan::commandBuffer commandBuffer;
+            // 为true时, 下一次重置commandPool时将其内存归还给系统, 用于该帧录制了远多于平常的命令之后
+            bool releaseCommandPoolResources = false;
+            // 每帧临时资源（如仅在该帧中使用的暂存缓冲区）的释放函数, 在该槽位的栅栏下一次被等待后执行
+            std::vector<std::function<void()>> callbacks_release;
+            // 该槽位最近一次所录制的帧的帧序号, 见graphicsBase::AdvanceFrameNumber()
+            uint64_t frameNumber = 0;
+            //--------------------
+            frame() {
+                commandPool.CommandPool().AllocateBuffers(commandBuffer);
+            }
+            frame(frame&&) = delete;
+            //Non-const Function
+            void ReleaseTransientResources() {
+                for (auto& i : callbacks_release)
+                    i();
+                callbacks_release.clear();
+            }
+        };
+    private:
+        frame frames[maxFramesInFlight];
+        uint32_t currentFrame = 0;
+    public:
+        frameContext() = default;
+        frameContext(frameContext&&) = delete;
+        ~frameContext() {
+            for (auto& i : frames)
+                i.fence.Wait(),
+                i.ReleaseTransientResources(),
+                graphicsBase::Base().UntrackFence(i.fence);
+            graphicsBase::Base().RetireFrame(graphicsBase::Base().FrameNumber());
+        }
+        //Getter
+        uint32_t CurrentFrameIndex() const {
+            return currentFrame;
+        }
+        frame& CurrentFrame() {
+            return frames[currentFrame];
+        }
+        frame& Frame(uint32_t index) {
+            return frames[index];
+        }
+        //Static Function
+        static constexpr uint32_t FrameCount() {
+            return maxFramesInFlight;
+        }
+        //Non-const Function
+        // 等待当前槽位上一次提交的命令执行完毕, 然后重置该槽位的命令池, 释放该槽位的临时资源, 并执行延迟销毁
+        result_t WaitForFrame() {
+            auto& current = frames[currentFrame];
+            if (VkResult result = current.fence.Wait())
+                return result;
+            // 各槽位轮流使用, 每个槽位在重用前均被等待, 故当前槽位的帧是仍在执行的帧中最早的, 更早的帧均已执行完毕
+            graphicsBase::Base().RetireFrame(current.frameNumber);
+            // 一次重置整个命令池, 而非在开始录制时逐个隐式重置命令缓冲区
+            if (VkResult result = current.commandPool.Reset(current.releaseCommandPoolResources))
+                return result;
+            current.releaseCommandPoolResources = false;
+            current.ReleaseTransientResources();
+            current.frameNumber = graphicsBase::Base().AdvanceFrameNumber();
+            return VK_SUCCESS;
+        }
+        // 获取交换链图像, 若该图像仍被其他槽位的命令使用则等待之, 然后将当前槽位的栅栏重置
+        // 每张交换链图像最近一次被哪个槽位的栅栏所保护由graphicsBase记录, 交换链图像数与槽位数不一致或获取顺序不定时, 防止两个槽位同时写入同一张图像, 重建交换链时亦据此等待
+        result_t AcquireImage() {
+            auto& current = frames[currentFrame];
+            if (VkResult result = graphicsBase::Base().SwapImage(current.semaphore_imageIsAvailable))
+                return result;
+            uint32_t imageIndex = graphicsBase::Base().CurrentImageIndex();
+            VkFence imageFence = graphicsBase::Base().SwapchainImageFence(imageIndex);
+            if (imageFence &&
+                imageFence != current.fence)
+                if (VkResult result = vkWaitForFences(graphicsBase::Base().Device(), 1, &imageFence, VK_TRUE, UINT64_MAX)) {
+                    outStream << std::format("[ frameContext ] ERROR\nFailed to wait for the fence of the swapchain image!\nError code: {}\n", int32_t(result));
+                    return result;
+                }
+            graphicsBase::Base().SwapchainImageFence(imageIndex, current.fence);
+            // 在成功获取图像后才重置栅栏, 以免获取失败时下一次等待该栅栏发生死锁
+            return current.fence.Reset();
+        }
+        result_t BeginFrame() {
+            if (VkResult result = WaitForFrame())
+                return result;
+            return AcquireImage();
+        }
+        // 提交当前槽位的命令缓冲区, 等待图像可用的信号量, 命令完成后置位渲染完成的信号量和栅栏
+        result_t Submit() {
+            return Submit(frames[currentFrame].commandBuffer);
+        }
+        // 以当前槽位的同步对象提交指定的命令缓冲区, 用于提交预录制的命令缓冲区（见staticCommandBuffers）
+        result_t Submit(VkCommandBuffer commandBuffer) {
+            auto& current = frames[currentFrame];
+            return graphicsBase::Base().SubmitCommandBuffer_Graphics(commandBuffer, current.semaphore_imageIsAvailable, current.semaphore_renderingIsOver, current.fence);
+        }
+        // 呈现图像, 然后切换到下一个槽位
+        result_t Present() {
+            VkResult result = graphicsBase::Base().PresentImage(frames[currentFrame].semaphore_renderingIsOver);
+            currentFrame = (currentFrame + 1) % maxFramesInFlight;
+            return result;
+        }
+        result_t EndFrame() {
+            if (VkResult result = Submit())
+                return result;
+            return Present();
+        }
+    };
+    // 预录制的命令缓冲区, 用于很少变化的静态内容: 录制一次, 之后每帧直接提交或执行, 省去逐帧录制的开销
+    // level为VK_COMMAND_BUFFER_LEVEL_PRIMARY时, 每张交换链图像各录制一个一级命令缓冲区, 录制函数录制完整的一帧（含渲染通道的开始和结束）, 以frameContext::Submit(...)提交
+    // level为VK_COMMAND_BUFFER_LEVEL_SECONDARY时, 只录制一个在renderPass的subpass中执行的二级命令缓冲区, 录制函数所得的imageIndex总为0, 在渲染通道中以CmdExecute(...)执行
+    // 录制在首次取用时进行; 交换链重建时（通过PushCallback_DestroySwapchain(...)）自动失效, 场景变化时调用Invalidate()使之失效, 失效的命令缓冲区被延迟销毁
+    // 一级命令缓冲区不带VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT, frameContext::AcquireImage()在图像被其他槽位使用时等待其栅栏, 故同一张图像的命令缓冲区不会在执行中被再次提交
+    class staticCommandBuffers {
+        vulkan::commandPool commandPool;
+        std::vector<vulkan::commandBuffer> commandBuffers;
+        std::vector<uint8_t> recorded;
+        VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+        uint32_t subpass = 0;
+        std::function<void(VkCommandBuffer, uint32_t)> callback_record;
+        uint32_t recordCount = 0;
+        // 所有实例, 交换链销毁时使之一并失效
+        inline static std::vector<staticCommandBuffers*> instances;
+        // 回调函数不可移除, 只注册一次
+        inline static bool callbackRegistered = false;
+        //--------------------
+        static void InvalidateAll_Internal() {
+            for (auto i : instances)
+                i->Invalidate();
+        }
+        result_t Record_Internal(uint32_t index) {
+            if (!commandPool)
+                if (VkResult result = commandPool.Create(graphicsBase::Base().QueueFamilyIndex_Graphics()))
+                    return result;
+            uint32_t count = level == VK_COMMAND_BUFFER_LEVEL_PRIMARY ? graphicsBase::Base().SwapchainImageCount() : 1;
+            if (commandBuffers.size() < count)
+                commandBuffers.resize(count),
+                recorded.resize(count);
+            auto& commandBuffer = commandBuffers[index];
+            if (!commandBuffer)
+                if (VkResult result = commandPool.AllocateBuffers(commandBuffer, level))
+                    return result;
+            VkResult result = VK_SUCCESS;
+            if (level == VK_COMMAND_BUFFER_LEVEL_PRIMARY)
+                result = commandBuffer.Begin();
+            else {
+                VkCommandBufferInheritanceInfo inheritanceInfo = {
+                    .renderPass = renderPass,
+                    .subpass = subpass
+                };
+                result = commandBuffer.Begin(VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT, inheritanceInfo);
+            }
+            if (result)
+                return result;
+            callback_record(commandBuffer, index);
+            result = commandBuffer.End();
+            if (result)
+                return result;
+            recorded[index] = true;
+            recordCount++;
+            return VK_SUCCESS;
+        }
+    public:
+        staticCommandBuffers(VkCommandBufferLevel level, std::function<void(VkCommandBuffer commandBuffer, uint32_t imageIndex)> callback_record,
+            VkRenderPass renderPass = VK_NULL_HANDLE, uint32_t subpass = 0) :
+            level(level), renderPass(renderPass), subpass(subpass), callback_record(std::move(callback_record)) {
+            if (!callbackRegistered)
+                graphicsBase::Base().PushCallback_DestroySwapchain(InvalidateAll_Internal),
+                callbackRegistered = true;
+            instances.push_back(this);
+        }
+        staticCommandBuffers(staticCommandBuffers&&) = delete;
+        ~staticCommandBuffers() {
+            // 交换链销毁时的回调不可移除, 实例为空时InvalidateAll_Internal()什么也不做
+            instances.erase(std::find(instances.begin(), instances.end(), this));
+        }
+        //Getter
+        // 自创建以来录制的次数, 用于确认录制未逐帧发生
+        uint32_t RecordCount() const {
+            return recordCount;
+        }
+        //Non-const Function
+        // 取得imageIndex对应的命令缓冲区, 未录制或已失效时先录制之, 录制失败时返回VK_NULL_HANDLE
+        VkCommandBuffer CommandBuffer(uint32_t imageIndex = graphicsBase::Base().CurrentImageIndex()) {
+            if (level == VK_COMMAND_BUFFER_LEVEL_SECONDARY)
+                imageIndex = 0;
+            if (imageIndex >= recorded.size() || !recorded[imageIndex])
+                if (Record_Internal(imageIndex))
+                    return VK_NULL_HANDLE;
+            return commandBuffers[imageIndex];
+        }
+        // 在一级命令缓冲区的渲染通道中执行二级命令缓冲区, 该渲染通道须以VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS开始
+        void CmdExecute(VkCommandBuffer commandBuffer) {
+            if (VkCommandBuffer secondary = CommandBuffer(0))
+                vkCmdExecuteCommands(commandBuffer, 1, &secondary);
+        }
+        // 使所有录制失效, 下次取用时重新录制; 命令缓冲区可能仍在执行中, 其命令池被延迟销毁
+        void Invalidate() {
+            commandPool.DeferDestroy();
+            commandBuffers.clear();
+            recorded.clear();
+        }
+    };
 }
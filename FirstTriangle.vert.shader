@@ -6,21 +6,19 @@ out gl_PerVertex {
     vec4 gl_Position;
 };
 
-layout(location = 0) out vec3 fragColor;
+// 顶点由CPU每帧写入上传环形缓冲区
+layout(location = 0) in vec2 i_Position;
+layout(location = 1) in vec3 i_Color;
+// 逐实例: 物体的包围球, xy为物体的位置, w为三角形的缩放倍数
+layout(location = 2) in vec4 i_Bounds;
 
-vec2 positions[3] = vec2[](
-    vec2(0.0, -0.5),
-    vec2(0.4, 0.5),
-    vec2(-0.4, 0.5)
-);
+layout(push_constant) uniform pushConstants {
+    mat4 viewProjection;
+};
 
-vec3 colors[3] = vec3[](
-    vec3(1.0, 0.0, 0.0),
-    vec3(0.0, 1.0, 0.0),
-    vec3(0.0, 0.0, 1.0)
-);
+layout(location = 0) out vec3 fragColor;
 
 void main() {
-    gl_Position = vec4(positions[gl_VertexIndex], 0.0, 1.0);
-    fragColor = colors[gl_VertexIndex];
+    gl_Position = viewProjection * vec4(i_Position * i_Bounds.w + i_Bounds.xy, 0.0, 1.0);
+    fragColor = i_Color;
 }
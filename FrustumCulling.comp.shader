@@ -0,0 +1,60 @@
+#version 450
+#pragma shader_stage(compute)
+
+layout(local_size_x = 64) in;
+
+struct drawParameters {
+    uint indexCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint padding;
+};
+// 与VkDrawIndexedIndirectCommand的内存布局一致
+struct drawIndexedIndirectCommand {
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint firstInstance;
+};
+
+// 各物体的包围球, xyz为球心, w为半径
+layout(std430, binding = 0) readonly buffer objectBoundsBuffer {
+    vec4 objectBounds[];
+};
+layout(std430, binding = 1) readonly buffer drawParametersBuffer {
+    drawParameters draws[];
+};
+layout(std430, binding = 2) writeonly buffer drawCommandBuffer {
+    drawIndexedIndirectCommand drawCommands[];
+};
+// 每帧在剔除前被清零
+layout(std430, binding = 3) buffer drawCountBuffer {
+    uint drawCount;
+};
+
+layout(push_constant) uniform pushConstants {
+    vec4 frustumPlanes[6];
+    uint objectCount;
+    // 为0时不压缩输出, 被剔除的物体的instanceCount为0, 供不支持vkCmdDrawIndexedIndirectCount时使用
+    uint compact;
+};
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= objectCount)
+        return;
+    vec4 sphere = objectBounds[index];
+    bool visible = true;
+    for (int i = 0; i < 6; i++)
+        visible = visible && dot(frustumPlanes[i].xyz, sphere.xyz) + frustumPlanes[i].w >= -sphere.w;
+    drawParameters draw = draws[index];
+    // firstInstance为物体索引, 顶点着色器可以gl_InstanceIndex取得逐物体的数据
+    if (compact != 0) {
+        if (!visible)
+            return;
+        drawCommands[atomicAdd(drawCount, 1)] = drawIndexedIndirectCommand(draw.indexCount, 1, draw.firstIndex, draw.vertexOffset, index);
+    }
+    else
+        drawCommands[index] = drawIndexedIndirectCommand(draw.indexCount, visible ? 1 : 0, draw.firstIndex, draw.vertexOffset, index);
+}
@@ -81,11 +81,74 @@ bool InitializeWindow(VkExtent2D size, bool fullScreen = false, bool isResizable
 	// 创建swap chain
 	if (graphicsBase::Base().CreateSwapchain(limitFrameRate))
 		return false;
+	// 拖拽窗口边框时尺寸会连续变化, 由graphicsBase推迟并合并交换链的重建
+	glfwSetFramebufferSizeCallback(pWindow, [](GLFWwindow*, int, int) {
+		graphicsBase::Base().NotifyResize();
+		});
 
 	return true;
 }
 
-// 终止窗口
+// 初始化无窗口（headless）渲染，不创建GLFW窗口，用于没有显示器的渲染节点或CI，如仅有lavapipe等CPU实现的机器
+// 若实例支持VK_EXT_headless_surface，则创建headless surface及交换链，否则渲染到graphicsBase持有的imageCount张离屏图像，二者对渲染循环而言与窗口的交换链无异
+bool InitializeHeadless(VkExtent2D size, uint32_t imageCount = 3, bool limitFrameRate = false) {
+	using namespace vulkan;
+
+	// 获取最新api版本
+	graphicsBase::Base().UseLatestApiVersion();
+	const char* headlessSurfaceExtensions[] = { VK_KHR_SURFACE_EXTENSION_NAME, VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME };
+	graphicsBase::Base().CheckInstanceExtensions(headlessSurfaceExtensions, nullptr);
+	bool useHeadlessSurface = headlessSurfaceExtensions[0] && headlessSurfaceExtensions[1];
+	if (useHeadlessSurface)
+		graphicsBase::Base().PushInstanceExtension(VK_KHR_SURFACE_EXTENSION_NAME),
+		graphicsBase::Base().PushInstanceExtension(VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME);
+	// 创建vulkan instance
+	if (graphicsBase::Base().CreateInstance())
+		return false;
+
+	// 创建headless surface，失败时退回到离屏图像
+	if (useHeadlessSurface) {
+		PFN_vkCreateHeadlessSurfaceEXT CreateHeadlessSurface =
+			reinterpret_cast<PFN_vkCreateHeadlessSurfaceEXT>(vkGetInstanceProcAddr(graphicsBase::Base().Instance(), "vkCreateHeadlessSurfaceEXT"));
+		VkHeadlessSurfaceCreateInfoEXT headlessSurfaceCreateInfo = { VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT };
+		VkSurfaceKHR surface = VK_NULL_HANDLE;
+		if (CreateHeadlessSurface &&
+			!CreateHeadlessSurface(graphicsBase::Base().Instance(), &headlessSurfaceCreateInfo, nullptr, &surface))
+			graphicsBase::Base().Surface(surface);
+		else
+			std::cout << std::format("[ InitializeHeadless ] WARNING\nFailed to create a headless surface, render to offscreen images instead!\n"),
+			useHeadlessSurface = false;
+	}
+
+	// 选择物理设备
+	if (graphicsBase::Base().GetPhysicalDevices() ||
+		graphicsBase::Base().DeterminePhysicalDevice(0, true, false))
+		return false;
+	// 交换链扩展不可用时仍可渲染到离屏图像，此时图像在一帧结束时的布局为VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+	const char* swapchainExtension[] = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+	graphicsBase::Base().CheckDeviceExtensions(swapchainExtension);
+	if (swapchainExtension[0])
+		graphicsBase::Base().PushDeviceExtension(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+	else if (useHeadlessSurface) {
+		std::cout << std::format("[ InitializeHeadless ] ERROR\nVK_KHR_swapchain is required by the headless surface!\n");
+		return false;
+	}
+	if (graphicsBase::Base().CreateDevice())
+		return false;
+
+	// 创建swap chain或离屏图像
+	if (useHeadlessSurface) {
+		graphicsBase::Base().SwapchainHint(size, imageCount);
+		if (graphicsBase::Base().CreateSwapchain(limitFrameRate))
+			return false;
+	}
+	else if (graphicsBase::Base().CreateOffscreenSwapchain(size, imageCount))
+		return false;
+
+	return true;
+}
+
+// 终止窗口，亦用于终止无窗口渲染（未初始化GLFW时调用glfwTerminate()无副作用）
 void TerminateWindow() {
 	vulkan::graphicsBase::Base().WaitIdle();
 	glfwTerminate();
@@ -104,21 +167,19 @@ void MakeWindowWindowed(VkOffset2D position, VkExtent2D size) {
 }
 
 // 窗口标题显示fps
-void TitleFps() {
-	static double time0 = glfwGetTime();
-	static double time1;
-	static double dt;
-	static int dframe = -1;
-	static std::stringstream info;
-	time1 = glfwGetTime();
-	dframe++;
-	if ((dt = time1 - time0) >= 1) {
-		info.precision(1);
-		info << windowTitle << "    " << std::fixed << dframe / dt << " FPS";
+// 每秒更新一次标题，除帧率外显示帧时长的p50和p99，帧时长的统计来自渲染循环中的frameInstrumentation
+void TitleFps(const frameInstrumentation& instrumentation) {
+	static auto time0 = std::chrono::steady_clock::now();
+	static uint64_t frameCount0 = instrumentation.FrameCount();
+	auto time1 = std::chrono::steady_clock::now();
+	double dt = std::chrono::duration<double>(time1 - time0).count();
+	if (dt >= 1) {
+		auto& frameTime = instrumentation.Histogram(frameInstrumentation::phase_frame);
+		std::string info = std::format("{}    {:.1f} FPS    p50 {:.2f} ms    p99 {:.2f} ms", windowTitle,
+			(instrumentation.FrameCount() - frameCount0) / dt, frameTime.Percentile(50) * 1e-6, frameTime.Percentile(99) * 1e-6);
 		// glfwSetWindowTitle用于设置窗口标题
-		glfwSetWindowTitle(pWindow, info.str().c_str());
-		info.str("");
+		glfwSetWindowTitle(pWindow, info.c_str());
 		time0 = time1;
-		dframe = 0;
+		frameCount0 = instrumentation.FrameCount();
 	}
 }
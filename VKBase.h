@@ -6,6 +6,10 @@
 #define MoveHandle handle = other.handle; other.handle = VK_NULL_HANDLE;
 #define DefineHandleTypeOperator operator decltype(handle)() const { return handle; }
 #define DefineAddressFunction const decltype(handle)* Address() const { return &handle; }
+// 将handle交给graphicsBase延迟销毁, 以帧序号或时间线信号量的值为键, 使其在可能引用它的GPU命令执行完毕后才被销毁
+#define DefineDeferredDestroyFunction(Func) \
+void DeferDestroy() { if (handle) { graphicsBase::Base().DeferDestruction([device = graphicsBase::Base().Device(), handle = handle] { Func(device, handle, nullptr); }); handle = VK_NULL_HANDLE; } } \
+void DeferDestroy(VkSemaphore semaphore_timeline, uint64_t value) { if (handle) { graphicsBase::Base().DeferDestruction(semaphore_timeline, value, [device = graphicsBase::Base().Device(), handle = handle] { Func(device, handle, nullptr); }); handle = VK_NULL_HANDLE; } }
 
 #ifndef NDEBUG
 #define ENABLE_DEBUG_MESSENGER true
@@ -52,6 +56,23 @@ namespace vulkan {
 	using result_t = VkResult;
 #endif
 
+	// 提交命令缓冲区时需等待或置位的信号量, 对二值信号量而言value被忽略, stage仅对等待有意义
+	struct semaphoreSubmitInfo {
+		VkSemaphore semaphore = VK_NULL_HANDLE;
+		uint64_t value = 0;
+		VkPipelineStageFlags stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+	};
+
+	// 由各封装类型向graphicsBase报告数量的对象类型, 见graphicsBase::ResourceCount(...)
+	enum resourceType {
+		resourceType_deviceMemory,
+		resourceType_buffer,
+		resourceType_image,
+		resourceType_pipeline,
+		resourceType_commandPool,
+		resourceTypeCount
+	};
+
 	class graphicsBase {
 		uint32_t apiVersion = VK_API_VERSION_1_0;
 		// 单例类对象是静态的，未设定初始值亦无构造函数的成员会被零初始化
@@ -59,6 +80,17 @@ namespace vulkan {
 		VkPhysicalDevice physicalDevice;
 		VkPhysicalDeviceProperties physicalDeviceProperties;
 		VkPhysicalDeviceMemoryProperties physicalDeviceMemoryProperties;
+		VkPhysicalDeviceFeatures physicalDeviceFeatures;
+		VkPhysicalDeviceVulkan11Features physicalDeviceVulkan11Features;
+		VkPhysicalDeviceVulkan12Features physicalDeviceVulkan12Features;
+		VkPhysicalDeviceVulkan13Features physicalDeviceVulkan13Features;
+		// vkCmdPipelineBarrier2或vkCmdPipelineBarrier2KHR, 不支持synchronization2时为nullptr
+		PFN_vkCmdPipelineBarrier2 pfnCmdPipelineBarrier2 = nullptr;
+		// vkCmdDrawIndexedIndirectCount或vkCmdDrawIndexedIndirectCountKHR, 不支持时为nullptr
+		PFN_vkCmdDrawIndexedIndirectCount pfnCmdDrawIndexedIndirectCount = nullptr;
+		// vkCmdBeginRendering和vkCmdEndRendering或其KHR版本, 不支持动态渲染时为nullptr
+		PFN_vkCmdBeginRendering pfnCmdBeginRendering = nullptr;
+		PFN_vkCmdEndRendering pfnCmdEndRendering = nullptr;
 		std::vector<VkPhysicalDevice> availablePhysicalDevices;
 
 		VkDevice device;
@@ -66,9 +98,12 @@ namespace vulkan {
 		uint32_t queueFamilyIndex_graphics = VK_QUEUE_FAMILY_IGNORED;
 		uint32_t queueFamilyIndex_presentation = VK_QUEUE_FAMILY_IGNORED;
 		uint32_t queueFamilyIndex_compute = VK_QUEUE_FAMILY_IGNORED;
+		// 专用于数据传送（不支持图形和计算）的队列族, 没有时为VK_QUEUE_FAMILY_IGNORED
+		uint32_t queueFamilyIndex_transfer = VK_QUEUE_FAMILY_IGNORED;
 		VkQueue queue_graphics;
 		VkQueue queue_presentation;
 		VkQueue queue_compute;
+		VkQueue queue_transfer;
 
 		VkSurfaceKHR surface;
 		std::vector <VkSurfaceFormatKHR> availableSurfaceFormats;
@@ -80,6 +115,49 @@ namespace vulkan {
 		uint32_t currentImageIndex = 0;
 		// 保存交换链的创建信息以便重建交换链
 		VkSwapchainCreateInfoKHR swapchainCreateInfo = {};
+		// 当surface不指定图像尺寸时（如headless surface）所用的交换链图像尺寸, 及期望的交换链图像数量（为0时由CreateSwapchain决定）
+		VkExtent2D swapchainExtentHint = defaultWindowSize;
+		uint32_t swapchainImageCountHint = 0;
+		// 无窗口渲染时代替交换链图像的离屏图像所绑定的设备内存, 离屏图像本身存放在swapchainImages中
+		std::vector<VkDeviceMemory> offscreenImageMemories;
+		// 每张交换链图像最近一次被写入时所提交的栅栏, 重建交换链时只需等待这些栅栏, 而不必等待队列闲置
+		std::vector<VkFence> swapchainImageFences;
+		// 是否曾登记过上述栅栏, 若从未登记, 重建交换链时仍等待队列闲置
+		bool swapchainImageFencesTracked;
+		// 被重建交换链所取代的旧交换链, 在新交换链上首次提交的命令（以fence判断）执行完后才被销毁
+		struct retiredSwapchain {
+			VkSwapchainKHR swapchain;
+			VkFence fence;
+		};
+		std::vector<retiredSwapchain> retiredSwapchains;
+		// 窗口尺寸变化后, 待其在swapchainRecreationDelay内不再变化才重建交换链, 使连续的尺寸变化只引发一次重建
+		bool swapchainRecreationPending;
+		std::chrono::steady_clock::time_point time_lastResize;
+		std::chrono::steady_clock::duration swapchainRecreationDelay = std::chrono::milliseconds(50);
+
+		// 延迟销毁的对象, semaphore_timeline为VK_NULL_HANDLE时value为帧序号, 否则为该时间线信号量须达到的值
+		struct deferredDestruction {
+			VkSemaphore semaphore_timeline;
+			uint64_t value;
+			std::function<void()> destroy;
+		};
+		std::vector<deferredDestruction> deferredDestructions;
+		// 当前帧的帧序号, 及已执行完毕的最新一帧的帧序号, 帧序号从1开始, 0表示尚未开始任何帧
+		uint64_t frameNumber;
+		uint64_t completedFrameNumber;
+
+		// 各内存堆的预算和用量, 由UpdateMemoryBudget()刷新
+		// 未启用VK_EXT_memory_budget时, 预算为堆大小的80%, 用量为经deviceMemory分配的大小
+		VkDeviceSize memoryHeapBudgets[VK_MAX_MEMORY_HEAPS];
+		VkDeviceSize memoryHeapUsages[VK_MAX_MEMORY_HEAPS];
+		// 经deviceMemory分配的各内存堆的大小, 及各类对象的数量和所占内存的大小, 可在多个线程中更新
+		std::atomic<int64_t> allocatedSizes[VK_MAX_MEMORY_HEAPS];
+		std::atomic<int64_t> resourceCounts[resourceTypeCount];
+		std::atomic<int64_t> resourceSizes[resourceTypeCount];
+		// 用量占预算的比例的阈值（升序）, 及各内存堆的用量当前超出的阈值个数
+		std::vector<float> memoryWatermarks = { 0.75f, 0.9f };
+		uint32_t memoryWatermarkLevels[VK_MAX_MEMORY_HEAPS];
+		std::vector<std::function<void(uint32_t heapIndex, float watermark, bool exceeded)>> callbacks_memoryWatermark;
 
 		std::vector<const char*> instanceLayers;
 		std::vector<const char*> instanceExtensions;
@@ -87,6 +165,9 @@ namespace vulkan {
 
 		VkDebugUtilsMessengerEXT debugUtilsMessenger;
 
+		// 未显式指定管线缓存时, 创建管线所用的默认管线缓存, 其生命周期由设置者管理
+		VkPipelineCache pipelineCache;
+
 		std::vector<void(*)()> callbacks_createSwapchain;
 		std::vector<void(*)()> callbacks_destroySwapchain;
 		std::vector<void(*)()> callbacks_createDevice;
@@ -102,14 +183,19 @@ namespace vulkan {
 				return;
 			if (device) {
 				WaitIdle();
-				if (swapchain) {
+				if (swapchain || IsOffscreen()) {
 					for (auto& i : callbacks_destroySwapchain)
 						i();
 					for (auto& i : swapchainImageViews)
 						if (i)
 							vkDestroyImageView(device, i, nullptr);
-					vkDestroySwapchainKHR(device, swapchain, nullptr);
+					if (swapchain)
+						vkDestroySwapchainKHR(device, swapchain, nullptr);
+					DestroyOffscreenImages_Internal();
 				}
+				DestroyRetiredSwapchains_Internal(true);
+				// 先执行延迟销毁, 使销毁逻辑设备时的回调函数（如释放内存分配器的内存块）之后不再有对象被销毁
+				DestroyDeferred_Internal(true);
 				for (auto& i : callbacks_destroyDevice)
 					i();
 				vkDestroyDevice(device, nullptr);
@@ -124,14 +210,17 @@ namespace vulkan {
 			}
 			vkDestroyInstance(instance, nullptr);
 		}
-		// 被CreateSwapchain和RecreateSwapchain调用
+		// 被CreateSwapchain调用
 		result_t CreateSwapchain_Internal() {
 			// 根据swapchainCreateInfo创建swap chain
 			if (VkResult result = vkCreateSwapchainKHR(device, &swapchainCreateInfo, nullptr, &swapchain)) {
 				outStream << std::format("[ graphicsBase ] ERROR\nFailed to create a swapchain!\nError code: {}\n", int32_t(result));
 				return result;
 			}
-
+			return GetSwapchainImages_Internal();
+		}
+		// 获取swapchain的图像并为其创建image view, 被CreateSwapchain_Internal和RecreateSwapchain调用
+		result_t GetSwapchainImages_Internal() {
 			// 获取swap chain对应的images
 			uint32_t swapchainImageCount;
 			if (VkResult result = vkGetSwapchainImagesKHR(device, swapchain, &swapchainImageCount, nullptr)) {
@@ -144,8 +233,13 @@ namespace vulkan {
 				return result;
 			}
 
+			return CreateSwapchainImageViews_Internal();
+		}
+		// 为swapchainImages中的图像创建image view, 被CreateSwapchain_Internal和CreateOffscreenSwapchain调用
+		result_t CreateSwapchainImageViews_Internal() {
 			// 为swap chain中的image创建image view, 图像视图（VkImageView）定义了图像的使用方式
-			swapchainImageViews.resize(swapchainImageCount);
+			swapchainImageViews.resize(swapchainImages.size());
+			swapchainImageFences.assign(swapchainImages.size(), VK_NULL_HANDLE);
 			VkImageViewCreateInfo imageViewCreateInfo = {
 				.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
 				.viewType = VK_IMAGE_VIEW_TYPE_2D,
@@ -153,7 +247,7 @@ namespace vulkan {
 				//.components = {},
 				.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
 			};
-			for (size_t i = 0; i < swapchainImageCount; i++) {
+			for (size_t i = 0; i < swapchainImages.size(); i++) {
 				imageViewCreateInfo.image = swapchainImages[i];
 				if (VkResult result = vkCreateImageView(device, &imageViewCreateInfo, nullptr, &swapchainImageViews[i])) {
 					outStream << std::format("[ graphicsBase ] ERROR\nFailed to create a swapchain image view!\nError code: {}\n", int32_t(result));
@@ -163,16 +257,71 @@ namespace vulkan {
 			return VK_SUCCESS;
 		}
 
+		// 销毁已不再被使用的旧交换链, all为true时须确保设备已闲置
+		void DestroyRetiredSwapchains_Internal(bool all) {
+			std::erase_if(retiredSwapchains, [&](const retiredSwapchain& i) {
+				// 未登记栅栏时, 旧交换链在重建时已等待队列闲置, 可直接销毁
+				if (!all && swapchainImageFencesTracked &&
+					(!i.fence || vkGetFenceStatus(device, i.fence) != VK_SUCCESS))
+					return false;
+				vkDestroySwapchainKHR(device, i.swapchain, nullptr);
+				return true;
+			});
+		}
+		// 执行延迟销毁, all为true时须确保设备已闲置
+		void DestroyDeferred_Internal(bool all) {
+			// 每个时间线信号量只查询一次
+			std::vector<std::pair<VkSemaphore, uint64_t>> counterValues;
+			std::erase_if(deferredDestructions, [&](deferredDestruction& i) {
+				if (!all) {
+					if (!i.semaphore_timeline) {
+						if (i.value > completedFrameNumber)
+							return false;
+					}
+					else {
+						auto iterator = std::find_if(counterValues.begin(), counterValues.end(), [&](auto& j) { return j.first == i.semaphore_timeline; });
+						if (iterator == counterValues.end()) {
+							uint64_t value = 0;
+							if (VkResult result = vkGetSemaphoreCounterValue(device, i.semaphore_timeline, &value))
+								outStream << std::format("[ graphicsBase ] ERROR\nFailed to get the counter value of a timeline semaphore!\nError code: {}\n", int32_t(result));
+							iterator = counterValues.insert(counterValues.end(), { i.semaphore_timeline, value });
+						}
+						if (i.value > iterator->second)
+							return false;
+					}
+				}
+				i.destroy();
+				return true;
+			});
+		}
+		// 销毁离屏图像并释放其设备内存, 其image view须已被销毁
+		void DestroyOffscreenImages_Internal() {
+			if (!IsOffscreen())
+				return;
+			for (auto& i : swapchainImages)
+				vkDestroyImage(device, i, nullptr);
+			for (auto& i : offscreenImageMemories)
+				vkFreeMemory(device, i, nullptr);
+			swapchainImages.resize(0);
+			offscreenImageMemories.resize(0);
+		}
+
 		// 该函数被DeterminePhysicalDevice调用，用于检查物理设备是否满足所需的队列族类型，并将对应的队列族索引返回到queueFamilyIndices，执行成功时直接将索引写入相应成员变量
-		result_t GetQueueFamilyIndices(VkPhysicalDevice physicalDevice, bool enableGraphicsQueue, bool enableComputeQueue, uint32_t(&queueFamilyIndices)[3]) {
+		// 专用于数据传送的队列族是可选的, 找不到时不影响结果
+		result_t GetQueueFamilyIndices(VkPhysicalDevice physicalDevice, bool enableGraphicsQueue, bool enableComputeQueue, uint32_t(&queueFamilyIndices)[4]) {
 			uint32_t queueFamilyCount = 0;
 			vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
 			if (!queueFamilyCount)
 				return VK_RESULT_MAX_ENUM;
 			std::vector<VkQueueFamilyProperties> queueFamilyPropertieses(queueFamilyCount);
 			vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilyPropertieses.data());
-			auto& [ig, ip, ic] = queueFamilyIndices;
-			ig = ip = ic = VK_QUEUE_FAMILY_IGNORED;
+			auto& [ig, ip, ic, it] = queueFamilyIndices;
+			ig = ip = ic = it = VK_QUEUE_FAMILY_IGNORED;
+			for (uint32_t i = 0; i < queueFamilyCount; i++)
+				if (it == VK_QUEUE_FAMILY_IGNORED &&
+					queueFamilyPropertieses[i].queueFlags & VK_QUEUE_TRANSFER_BIT &&
+					!(queueFamilyPropertieses[i].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+					it = i;
 			for (uint32_t i = 0; i < queueFamilyCount; i++) {
 				VkBool32
 					supportGraphics = enableGraphicsQueue && queueFamilyPropertieses[i].queueFlags & VK_QUEUE_GRAPHICS_BIT,
@@ -212,8 +361,67 @@ namespace vulkan {
 			queueFamilyIndex_graphics = ig;
 			queueFamilyIndex_presentation = ip;
 			queueFamilyIndex_compute = ic;
+			queueFamilyIndex_transfer = it;
 			return VK_SUCCESS;
 		}
+		// 被CreateDevice调用, 取得物理设备支持的特性, Vulkan1.2及以上版本的特性须经由VkPhysicalDeviceFeatures2获取
+		void GetPhysicalDeviceFeatures() {
+			physicalDeviceVulkan11Features = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES };
+			physicalDeviceVulkan12Features = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+			physicalDeviceVulkan13Features = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES };
+			if (DeviceApiVersion() >= VK_API_VERSION_1_1) {
+				VkPhysicalDeviceFeatures2 physicalDeviceFeatures2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+				if (DeviceApiVersion() >= VK_API_VERSION_1_2) {
+					physicalDeviceFeatures2.pNext = &physicalDeviceVulkan11Features;
+					physicalDeviceVulkan11Features.pNext = &physicalDeviceVulkan12Features;
+					if (DeviceApiVersion() >= VK_API_VERSION_1_3)
+						physicalDeviceVulkan12Features.pNext = &physicalDeviceVulkan13Features;
+				}
+				vkGetPhysicalDeviceFeatures2(physicalDevice, &physicalDeviceFeatures2);
+				physicalDeviceFeatures = physicalDeviceFeatures2.features;
+			}
+			else
+				vkGetPhysicalDeviceFeatures(physicalDevice, &physicalDeviceFeatures);
+		}
+		// 被各SubmitCommandBuffer_*的多信号量版本调用, 二值信号量和时间线信号量可混用
+		result_t SubmitCommandBuffer_Internal(VkQueue queue, VkCommandBuffer commandBuffer,
+			arrayRef<const semaphoreSubmitInfo> waitSemaphores, arrayRef<const semaphoreSubmitInfo> signalSemaphores, VkFence fence) const {
+			size_t waitCount = waitSemaphores.Count();
+			size_t signalCount = signalSemaphores.Count();
+			std::vector<VkSemaphore> semaphores(waitCount + signalCount);
+			std::vector<uint64_t> values(waitCount + signalCount);
+			std::vector<VkPipelineStageFlags> waitDstStages(waitCount);
+			for (size_t i = 0; i < waitCount; i++)
+				semaphores[i] = waitSemaphores[i].semaphore,
+				values[i] = waitSemaphores[i].value,
+				waitDstStages[i] = waitSemaphores[i].stage;
+			for (size_t i = 0; i < signalCount; i++)
+				semaphores[waitCount + i] = signalSemaphores[i].semaphore,
+				values[waitCount + i] = signalSemaphores[i].value;
+			VkTimelineSemaphoreSubmitInfo timelineSemaphoreSubmitInfo = {
+				.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+				.waitSemaphoreValueCount = uint32_t(waitCount),
+				.pWaitSemaphoreValues = values.data(),
+				.signalSemaphoreValueCount = uint32_t(signalCount),
+				.pSignalSemaphoreValues = values.data() + waitCount
+			};
+			VkSubmitInfo submitInfo = {
+				.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+				// 不支持时间线信号量时不得在pNext链中包含VkTimelineSemaphoreSubmitInfo
+				.pNext = physicalDeviceVulkan12Features.timelineSemaphore ? &timelineSemaphoreSubmitInfo : nullptr,
+				.waitSemaphoreCount = uint32_t(waitCount),
+				.pWaitSemaphores = semaphores.data(),
+				.pWaitDstStageMask = waitDstStages.data(),
+				.commandBufferCount = 1,
+				.pCommandBuffers = &commandBuffer,
+				.signalSemaphoreCount = uint32_t(signalCount),
+				.pSignalSemaphores = semaphores.data() + waitCount
+			};
+			VkResult result = vkQueueSubmit(queue, 1, &submitInfo, fence);
+			if (result)
+				outStream << std::format("[ graphicsBase ] ERROR\nFailed to submit the command buffer!\nError code: {}\n", int32_t(result));
+			return result;
+		}
 		result_t CreateDebugMessenger() {
 			static PFN_vkDebugUtilsMessengerCallbackEXT DebugUtilsMessengerCallback = [](
 				VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
@@ -269,6 +477,37 @@ namespace vulkan {
 		const VkPhysicalDeviceMemoryProperties& PhysicalDeviceMemoryProperties() const {
 			return physicalDeviceMemoryProperties;
 		}
+		const VkPhysicalDeviceFeatures& PhysicalDeviceFeatures() const {
+			return physicalDeviceFeatures;
+		}
+		const VkPhysicalDeviceVulkan11Features& PhysicalDeviceVulkan11Features() const {
+			return physicalDeviceVulkan11Features;
+		}
+		const VkPhysicalDeviceVulkan12Features& PhysicalDeviceVulkan12Features() const {
+			return physicalDeviceVulkan12Features;
+		}
+		const VkPhysicalDeviceVulkan13Features& PhysicalDeviceVulkan13Features() const {
+			return physicalDeviceVulkan13Features;
+		}
+		// 实例和物理设备所支持的API版本中较低者, 在选择物理设备并取得其属性后有效
+		uint32_t DeviceApiVersion() const {
+			return apiVersion < physicalDeviceProperties.apiVersion ? apiVersion : physicalDeviceProperties.apiVersion;
+		}
+		// Vulkan1.3或VK_KHR_synchronization2可用时为vkCmdPipelineBarrier2(KHR), 否则为nullptr, 在创建逻辑设备后有效
+		PFN_vkCmdPipelineBarrier2 CmdPipelineBarrier2() const {
+			return pfnCmdPipelineBarrier2;
+		}
+		// Vulkan1.2的drawIndirectCount特性或VK_KHR_draw_indirect_count可用时为vkCmdDrawIndexedIndirectCount(KHR), 否则为nullptr, 在创建逻辑设备后有效
+		PFN_vkCmdDrawIndexedIndirectCount CmdDrawIndexedIndirectCount() const {
+			return pfnCmdDrawIndexedIndirectCount;
+		}
+		// Vulkan1.3或VK_KHR_dynamic_rendering可用时为vkCmdBeginRendering(KHR)和vkCmdEndRendering(KHR), 否则为nullptr, 在创建逻辑设备后有效
+		PFN_vkCmdBeginRendering CmdBeginRendering() const {
+			return pfnCmdBeginRendering;
+		}
+		PFN_vkCmdEndRendering CmdEndRendering() const {
+			return pfnCmdEndRendering;
+		}
 		VkPhysicalDevice AvailablePhysicalDevice(uint32_t index) const {
 			return availablePhysicalDevices[index];
 		}
@@ -288,6 +527,15 @@ namespace vulkan {
 		uint32_t QueueFamilyIndex_Compute() const {
 			return queueFamilyIndex_compute;
 		}
+		// 没有专用于数据传送的队列族时, 返回图形队列族（未启用图形队列时为计算队列族）, 图形和计算队列亦支持数据传送
+		uint32_t QueueFamilyIndex_Transfer() const {
+			if (queueFamilyIndex_transfer != VK_QUEUE_FAMILY_IGNORED)
+				return queueFamilyIndex_transfer;
+			return queueFamilyIndex_graphics != VK_QUEUE_FAMILY_IGNORED ? queueFamilyIndex_graphics : queueFamilyIndex_compute;
+		}
+		bool HasDedicatedTransferQueue() const {
+			return queueFamilyIndex_transfer != VK_QUEUE_FAMILY_IGNORED;
+		}
 		VkQueue Queue_Graphics() const {
 			return queue_graphics;
 		}
@@ -297,6 +545,11 @@ namespace vulkan {
 		VkQueue Queue_Compute() const {
 			return queue_compute;
 		}
+		VkQueue Queue_Transfer() const {
+			if (queueFamilyIndex_transfer != VK_QUEUE_FAMILY_IGNORED)
+				return queue_transfer;
+			return queueFamilyIndex_graphics != VK_QUEUE_FAMILY_IGNORED ? queue_graphics : queue_compute;
+		}
 
 		VkSurfaceKHR Surface() const {
 			return surface;
@@ -333,6 +586,54 @@ namespace vulkan {
 			return swapchainCreateInfo;
 		}
 
+		VkPipelineCache PipelineCache() const {
+			return pipelineCache;
+		}
+
+		VkFence SwapchainImageFence(uint32_t index) const {
+			return swapchainImageFences[index];
+		}
+		// 是否有待执行的（被推迟的）交换链重建
+		bool SwapchainRecreationPending() const {
+			return swapchainRecreationPending;
+		}
+
+		uint64_t FrameNumber() const {
+			return frameNumber;
+		}
+		uint64_t CompletedFrameNumber() const {
+			return completedFrameNumber;
+		}
+		size_t DeferredDestructionCount() const {
+			return deferredDestructions.size();
+		}
+		VkDeviceSize MemoryHeapBudget(uint32_t heapIndex) const {
+			return memoryHeapBudgets[heapIndex];
+		}
+		VkDeviceSize MemoryHeapUsage(uint32_t heapIndex) const {
+			return memoryHeapUsages[heapIndex];
+		}
+		// 经deviceMemory分配的大小
+		VkDeviceSize AllocatedSize(uint32_t heapIndex) const {
+			return allocatedSizes[heapIndex];
+		}
+		int64_t ResourceCount(resourceType type) const {
+			return resourceCounts[type];
+		}
+		// 仅设备内存、缓冲区和图像有所占内存的大小, 缓冲区和图像的大小为其所请求的大小
+		int64_t ResourceSize(resourceType type) const {
+			return resourceSizes[type];
+		}
+		// 是否以离屏图像代替交换链（无窗口渲染）
+		bool IsOffscreen() const {
+			return offscreenImageMemories.size();
+		}
+		// 交换链图像在一帧渲染结束时应处于的布局, 未开启交换链扩展的离屏渲染不得使用VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+		VkImageLayout PresentLayout() const {
+			return IsDeviceExtensionEnabled(VK_KHR_SWAPCHAIN_EXTENSION_NAME) ?
+				VK_IMAGE_LAYOUT_PRESENT_SRC_KHR : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		}
+
 		const std::vector<const char*>& InstanceLayers() const {
 			return instanceLayers;
 		}
@@ -344,6 +645,26 @@ namespace vulkan {
 		}
 
 		//Const Function
+		std::string MemoryReport() const {
+			static constexpr const char* resourceTypeNames[resourceTypeCount] = { "deviceMemory", "buffer", "image", "pipeline", "commandPool" };
+			std::string report = std::format("{:<8}{:>14}{:>14}{:>14}{:>8}\n", "Heap", "budget (MiB)", "usage (MiB)", "ours (MiB)", "usage");
+			for (uint32_t i = 0; i < physicalDeviceMemoryProperties.memoryHeapCount; i++)
+				report += std::format("{:<8}{:>14.2f}{:>14.2f}{:>14.2f}{:>7.1f}%\n", i,
+					memoryHeapBudgets[i] / 1048576.0, memoryHeapUsages[i] / 1048576.0, allocatedSizes[i] / 1048576.0,
+					memoryHeapBudgets[i] ? 100.0 * memoryHeapUsages[i] / memoryHeapBudgets[i] : 0.0);
+			report += std::format("{:<16}{:>10}{:>14}\n", "Resource", "count", "size (MiB)");
+			for (uint32_t i = 0; i < resourceTypeCount; i++)
+				report += std::format("{:<16}{:>10}{:>14.2f}\n", resourceTypeNames[i], int64_t(resourceCounts[i]), resourceSizes[i] / 1048576.0);
+			return report;
+		}
+
+		bool IsDeviceExtensionEnabled(const char* extensionName) const {
+			for (auto& i : deviceExtensions)
+				if (!strcmp(extensionName, i))
+					return true;
+			return false;
+		}
+
 		VkResult WaitIdle() const {
 			VkResult result = vkDeviceWaitIdle(device);
 			if (result)
@@ -364,6 +685,17 @@ namespace vulkan {
 		void PushCallback_DestroyDevice(void(*function)()) {
 			callbacks_destroyDevice.push_back(function);
 		}
+		// 某内存堆的用量占预算的比例越过阈值时调用, exceeded为true表示从下方越过, 可用于在驱动开始换页或分配失败前减少流送的资源
+		void PushCallback_MemoryWatermark(std::function<void(uint32_t heapIndex, float watermark, bool exceeded)> function) {
+			callbacks_memoryWatermark.push_back(std::move(function));
+		}
+		// 设置用量占预算的比例的阈值, 会被排序
+		void MemoryWatermarks(std::vector<float> watermarks) {
+			std::ranges::sort(watermarks);
+			memoryWatermarks = std::move(watermarks);
+			for (auto& i : memoryWatermarkLevels)
+				i = 0;
+		}
 
 		// 用于创建Vulkan实例前
 		void PushInstanceLayer(const char* layerName) {
@@ -487,6 +819,112 @@ namespace vulkan {
 				this->surface = surface;
 		}
 
+		// 用于创建交换链前, 指定surface不限定图像尺寸时的图像尺寸, 及期望的图像数量
+		void SwapchainHint(VkExtent2D extent, uint32_t imageCount = 0) {
+			swapchainExtentHint = extent;
+			swapchainImageCountHint = imageCount;
+		}
+
+		// 登记写入交换链图像的命令所用的栅栏, 该栅栏在被登记后须被提交（或保持置位）, 不可在其被重置后闲置
+		void SwapchainImageFence(uint32_t index, VkFence fence) {
+			swapchainImageFencesTracked = true;
+			swapchainImageFences[index] = fence;
+			for (auto& i : retiredSwapchains)
+				if (!i.fence)
+					i.fence = fence;
+		}
+		// 在销毁先前登记过的栅栏前调用
+		void UntrackFence(VkFence fence) {
+			for (auto& i : swapchainImageFences)
+				if (i == fence)
+					i = VK_NULL_HANDLE;
+			for (auto& i : retiredSwapchains)
+				if (i.fence == fence)
+					i.fence = VK_NULL_HANDLE;
+		}
+		// 开始录制新的一帧前调用, 返回新的帧序号, 此后以帧序号为键延迟销毁的对象须待该帧执行完毕, 各内存堆的预算和用量亦在此刷新
+		uint64_t AdvanceFrameNumber() {
+			UpdateMemoryBudget();
+			return ++frameNumber;
+		}
+		// 刷新各内存堆的预算和用量, 用量越过阈值时调用相应的回调函数
+		void UpdateMemoryBudget() {
+			uint32_t heapCount = physicalDeviceMemoryProperties.memoryHeapCount;
+			if (IsDeviceExtensionEnabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)) {
+				VkPhysicalDeviceMemoryBudgetPropertiesEXT memoryBudgetProperties = {
+					.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT
+				};
+				VkPhysicalDeviceMemoryProperties2 physicalDeviceMemoryProperties2 = {
+					.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+					.pNext = &memoryBudgetProperties
+				};
+				vkGetPhysicalDeviceMemoryProperties2(physicalDevice, &physicalDeviceMemoryProperties2);
+				for (uint32_t i = 0; i < heapCount; i++)
+					memoryHeapBudgets[i] = memoryBudgetProperties.heapBudget[i],
+					memoryHeapUsages[i] = memoryBudgetProperties.heapUsage[i];
+			}
+			else
+				// 不知道其他进程的用量, 以堆大小的80%为预算
+				for (uint32_t i = 0; i < heapCount; i++)
+					memoryHeapBudgets[i] = physicalDeviceMemoryProperties.memoryHeaps[i].size / 5 * 4,
+					memoryHeapUsages[i] = VkDeviceSize(std::max(int64_t(allocatedSizes[i]), int64_t(0)));
+			for (uint32_t i = 0; i < heapCount; i++) {
+				if (!memoryHeapBudgets[i])
+					continue;
+				float ratio = float(memoryHeapUsages[i]) / memoryHeapBudgets[i];
+				uint32_t level = uint32_t(std::ranges::upper_bound(memoryWatermarks, ratio) - memoryWatermarks.begin());
+				uint32_t previousLevel = memoryWatermarkLevels[i];
+				memoryWatermarkLevels[i] = level;
+				for (uint32_t j = previousLevel; j < level; j++)
+					for (auto& k : callbacks_memoryWatermark)
+						k(i, memoryWatermarks[j], true);
+				for (uint32_t j = previousLevel; j > level; j--)
+					for (auto& k : callbacks_memoryWatermark)
+						k(i, memoryWatermarks[j - 1], false);
+			}
+		}
+		// 由各封装类型在创建和销毁对象时调用, count和size为增量
+		void CountResource(resourceType type, int64_t count, int64_t size = 0) {
+			resourceCounts[type] += count;
+			resourceSizes[type] += size;
+		}
+		// 由deviceMemory在分配和释放内存时调用, size为增量
+		void CountDeviceMemory(uint32_t memoryTypeIndex, int64_t count, int64_t size) {
+			allocatedSizes[physicalDeviceMemoryProperties.memoryTypes[memoryTypeIndex].heapIndex] += size;
+			CountResource(resourceType_deviceMemory, count, size);
+		}
+		// 告知帧序号不大于frameNumber的帧均已执行完毕, 然后一并销毁所有可被销毁的对象
+		void RetireFrame(uint64_t frameNumber) {
+			completedFrameNumber = std::max(completedFrameNumber, frameNumber);
+			DestroyDeferred_Internal(false);
+		}
+		// 销毁所有可被销毁的对象, 只以时间线信号量为键延迟销毁对象时, 须自行定期调用
+		void DestroyDeferred() {
+			DestroyDeferred_Internal(false);
+		}
+		// 在当前帧执行完毕后调用destroy, 对象通常通过各封装类型的DeferDestroy()被延迟销毁, destroy中不得再延迟销毁其他对象
+		void DeferDestruction(std::function<void()> destroy) {
+			deferredDestructions.push_back({ VK_NULL_HANDLE, frameNumber, std::move(destroy) });
+		}
+		// 在时间线信号量semaphore_timeline的值达到value后调用destroy
+		void DeferDestruction(VkSemaphore semaphore_timeline, uint64_t value, std::function<void()> destroy) {
+			deferredDestructions.push_back({ semaphore_timeline, value, std::move(destroy) });
+		}
+
+		// 窗口尺寸改变时调用（如在GLFW的帧缓冲尺寸回调中）, 交换链会在尺寸停止变化swapchainRecreationDelay后, 于SwapImage(...)中被重建
+		void NotifyResize() {
+			swapchainRecreationPending = true;
+			time_lastResize = std::chrono::steady_clock::now();
+		}
+		void SwapchainRecreationDelay(std::chrono::steady_clock::duration delay) {
+			swapchainRecreationDelay = delay;
+		}
+
+		// 设置默认管线缓存, 须在销毁该管线缓存前以VK_NULL_HANDLE调用
+		void PipelineCache(VkPipelineCache pipelineCache) {
+			this->pipelineCache = pipelineCache;
+		}
+
 		// 用于创建逻辑设备前
 		void PushDeviceExtension(const char* extensionName) {
 			AddLayerOrExtension(deviceExtensions, extensionName);
@@ -516,9 +954,10 @@ namespace vulkan {
 				uint32_t graphics = VK_QUEUE_FAMILY_IGNORED;
 				uint32_t presentation = VK_QUEUE_FAMILY_IGNORED;
 				uint32_t compute = VK_QUEUE_FAMILY_IGNORED;
+				uint32_t transfer = VK_QUEUE_FAMILY_IGNORED;
 			};
 			static std::vector<queueFamilyIndexCombination> queueFamilyIndexCombinations(availablePhysicalDevices.size());
-			auto& [ig, ip, ic] = queueFamilyIndexCombinations[deviceIndex];
+			auto& [ig, ip, ic, it] = queueFamilyIndexCombinations[deviceIndex];
 			if (ig == notFound && enableGraphicsQueue ||
 				ip == notFound && surface ||
 				ic == notFound && enableComputeQueue)
@@ -526,7 +965,7 @@ namespace vulkan {
 			if (ig == VK_QUEUE_FAMILY_IGNORED && enableGraphicsQueue ||
 				ip == VK_QUEUE_FAMILY_IGNORED && surface ||
 				ic == VK_QUEUE_FAMILY_IGNORED && enableComputeQueue) {
-				uint32_t indices[3];
+				uint32_t indices[4];
 				VkResult result = GetQueueFamilyIndices(availablePhysicalDevices[deviceIndex], enableGraphicsQueue, enableComputeQueue, indices);
 				if (result == VK_SUCCESS ||
 					result == VK_RESULT_MAX_ENUM) {
@@ -536,6 +975,8 @@ namespace vulkan {
 						ip = indices[1] & INT32_MAX;
 					if (enableComputeQueue)
 						ic = indices[2] & INT32_MAX;
+					// 专用于数据传送的队列族是可选的, 保留VK_QUEUE_FAMILY_IGNORED表示没有
+					it = indices[3];
 				}
 				if (result)
 					return result;
@@ -544,6 +985,7 @@ namespace vulkan {
 				queueFamilyIndex_graphics = enableGraphicsQueue ? ig : VK_QUEUE_FAMILY_IGNORED;
 				queueFamilyIndex_presentation = surface ? ip : VK_QUEUE_FAMILY_IGNORED;
 				queueFamilyIndex_compute = enableComputeQueue ? ic : VK_QUEUE_FAMILY_IGNORED;
+				queueFamilyIndex_transfer = it;
 			}
 			physicalDevice = availablePhysicalDevices[deviceIndex];
 			return VK_SUCCESS;
@@ -552,7 +994,11 @@ namespace vulkan {
 		/// 创建逻辑设备
 		result_t CreateDevice(const void* pNext = nullptr, VkDeviceCreateFlags flags = 0) {
 			float queuePriority = 1.f;
-			VkDeviceQueueCreateInfo queueCreateInfos[3] = {
+			VkDeviceQueueCreateInfo queueCreateInfos[4] = {
+				{
+					.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+					.queueCount = 1,
+					.pQueuePriorities = &queuePriority },
 				{
 					.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
 					.queueCount = 1,
@@ -575,18 +1021,72 @@ namespace vulkan {
 				queueFamilyIndex_compute != queueFamilyIndex_graphics &&
 				queueFamilyIndex_compute != queueFamilyIndex_presentation)
 				queueCreateInfos[queueCreateInfoCount++].queueFamilyIndex = queueFamilyIndex_compute;
+			// 专用于数据传送的队列族不支持图形和计算, 故必然与上述队列族不同
+			if (queueFamilyIndex_transfer != VK_QUEUE_FAMILY_IGNORED)
+				queueCreateInfos[queueCreateInfoCount++].queueFamilyIndex = queueFamilyIndex_transfer;
 
-			// test features
-			VkPhysicalDeviceFeatures2 deviceFeatures = {};
-			deviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
-			VkPhysicalDeviceVulkan13Features deviceFeatures13 = {};
-			deviceFeatures.pNext = &deviceFeatures13;
-			vkGetPhysicalDeviceFeatures2(physicalDevice, &deviceFeatures);
-			std::cout << std::format("[ physical device features ] : dynamicRendering is {}\n", deviceFeatures13.dynamicRendering);
-			// test features
-			// 获取物理设备的设备特性
-			VkPhysicalDeviceFeatures physicalDeviceFeatures;
-			vkGetPhysicalDeviceFeatures(physicalDevice, &physicalDeviceFeatures);
+			// 获取物理设备属性和设备特性, 开启所有可用的特性（如时间线信号量）
+			vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+			vkGetPhysicalDeviceMemoryProperties(physicalDevice, &physicalDeviceMemoryProperties);
+			GetPhysicalDeviceFeatures();
+			// 支持时开启VK_EXT_memory_budget, 查询预算需要Vulkan1.1的vkGetPhysicalDeviceMemoryProperties2
+			if (DeviceApiVersion() >= VK_API_VERSION_1_1) {
+				const char* extensionName = VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+				if (!CheckDeviceExtensions(extensionName) && extensionName)
+					PushDeviceExtension(extensionName);
+			}
+			// Vulkan1.3以下的设备支持时开启VK_KHR_synchronization2, 须同时在pNext链中开启synchronization2特性
+			VkPhysicalDeviceSynchronization2Features physicalDeviceSynchronization2Features = {
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES,
+				.synchronization2 = VK_TRUE
+			};
+			bool synchronization2Extension = false;
+			if (DeviceApiVersion() >= VK_API_VERSION_1_1 && DeviceApiVersion() < VK_API_VERSION_1_3) {
+				const char* extensionName = VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME;
+				if (!CheckDeviceExtensions(extensionName) && extensionName)
+					PushDeviceExtension(extensionName),
+					synchronization2Extension = true;
+			}
+			// Vulkan1.2的设备支持时开启VK_KHR_dynamic_rendering（其依赖的VK_KHR_depth_stencil_resolve在Vulkan1.2中已是核心功能）, 须同时在pNext链中开启dynamicRendering特性
+			VkPhysicalDeviceDynamicRenderingFeatures physicalDeviceDynamicRenderingFeatures = {
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES,
+				.dynamicRendering = VK_TRUE
+			};
+			bool dynamicRenderingExtension = false;
+			if (DeviceApiVersion() >= VK_API_VERSION_1_2 && DeviceApiVersion() < VK_API_VERSION_1_3) {
+				const char* extensionName = VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME;
+				if (!CheckDeviceExtensions(extensionName) && extensionName)
+					PushDeviceExtension(extensionName),
+					dynamicRenderingExtension = true;
+			}
+			// Vulkan1.2以下的设备支持时开启VK_KHR_draw_indirect_count
+			bool drawIndirectCountExtension = false;
+			if (DeviceApiVersion() >= VK_API_VERSION_1_1 && DeviceApiVersion() < VK_API_VERSION_1_2) {
+				const char* extensionName = VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME;
+				if (!CheckDeviceExtensions(extensionName) && extensionName)
+					PushDeviceExtension(extensionName),
+					drawIndirectCountExtension = true;
+			}
+			VkPhysicalDeviceFeatures2 physicalDeviceFeatures2 = {
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+				.pNext = const_cast<void*>(pNext),
+				.features = physicalDeviceFeatures
+			};
+			if (DeviceApiVersion() >= VK_API_VERSION_1_2) {
+				physicalDeviceFeatures2.pNext = &physicalDeviceVulkan11Features;
+				physicalDeviceVulkan11Features.pNext = &physicalDeviceVulkan12Features;
+				if (DeviceApiVersion() >= VK_API_VERSION_1_3)
+					physicalDeviceVulkan12Features.pNext = &physicalDeviceVulkan13Features,
+					physicalDeviceVulkan13Features.pNext = const_cast<void*>(pNext);
+				else
+					physicalDeviceVulkan12Features.pNext = const_cast<void*>(pNext);
+			}
+			if (synchronization2Extension)
+				physicalDeviceSynchronization2Features.pNext = physicalDeviceFeatures2.pNext,
+				physicalDeviceFeatures2.pNext = &physicalDeviceSynchronization2Features;
+			if (dynamicRenderingExtension)
+				physicalDeviceDynamicRenderingFeatures.pNext = physicalDeviceFeatures2.pNext,
+				physicalDeviceFeatures2.pNext = &physicalDeviceDynamicRenderingFeatures;
 			VkDeviceCreateInfo deviceCreateInfo = {
 				.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
 				.pNext = pNext,
@@ -597,6 +1097,10 @@ namespace vulkan {
 				.ppEnabledExtensionNames = deviceExtensions.data(),
 				.pEnabledFeatures = &physicalDeviceFeatures
 			};
+			// Vulkan1.1起以VkPhysicalDeviceFeatures2指定特性, 此时pEnabledFeatures须为nullptr
+			if (DeviceApiVersion() >= VK_API_VERSION_1_1)
+				deviceCreateInfo.pNext = &physicalDeviceFeatures2,
+				deviceCreateInfo.pEnabledFeatures = nullptr;
 			if (VkResult result = vkCreateDevice(physicalDevice, &deviceCreateInfo, nullptr, &device)) {
 				outStream << std::format("[ graphicsBase ] ERROR\nFailed to create a vulkan logical device!\nError code: {}\n", int32_t(result));
 				return result;
@@ -607,8 +1111,29 @@ namespace vulkan {
 				vkGetDeviceQueue(device, queueFamilyIndex_presentation, 0, &queue_presentation);
 			if (queueFamilyIndex_compute != VK_QUEUE_FAMILY_IGNORED)
 				vkGetDeviceQueue(device, queueFamilyIndex_compute, 0, &queue_compute);
-			vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
-			vkGetPhysicalDeviceMemoryProperties(physicalDevice, &physicalDeviceMemoryProperties);
+			if (queueFamilyIndex_transfer != VK_QUEUE_FAMILY_IGNORED)
+				vkGetDeviceQueue(device, queueFamilyIndex_transfer, 0, &queue_transfer);
+			pfnCmdPipelineBarrier2 = nullptr;
+			if (DeviceApiVersion() >= VK_API_VERSION_1_3 && physicalDeviceVulkan13Features.synchronization2)
+				pfnCmdPipelineBarrier2 = reinterpret_cast<PFN_vkCmdPipelineBarrier2>(vkGetDeviceProcAddr(device, "vkCmdPipelineBarrier2"));
+			else if (synchronization2Extension)
+				pfnCmdPipelineBarrier2 = reinterpret_cast<PFN_vkCmdPipelineBarrier2>(vkGetDeviceProcAddr(device, "vkCmdPipelineBarrier2KHR"));
+			pfnCmdDrawIndexedIndirectCount = nullptr;
+			if (DeviceApiVersion() >= VK_API_VERSION_1_2 && physicalDeviceVulkan12Features.drawIndirectCount)
+				pfnCmdDrawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCount>(vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCount"));
+			else if (drawIndirectCountExtension)
+				pfnCmdDrawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCount>(vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCountKHR"));
+			pfnCmdBeginRendering = nullptr;
+			pfnCmdEndRendering = nullptr;
+			if (DeviceApiVersion() >= VK_API_VERSION_1_3 && physicalDeviceVulkan13Features.dynamicRendering)
+				pfnCmdBeginRendering = reinterpret_cast<PFN_vkCmdBeginRendering>(vkGetDeviceProcAddr(device, "vkCmdBeginRendering")),
+				pfnCmdEndRendering = reinterpret_cast<PFN_vkCmdEndRendering>(vkGetDeviceProcAddr(device, "vkCmdEndRendering"));
+			else if (dynamicRenderingExtension)
+				pfnCmdBeginRendering = reinterpret_cast<PFN_vkCmdBeginRendering>(vkGetDeviceProcAddr(device, "vkCmdBeginRenderingKHR")),
+				pfnCmdEndRendering = reinterpret_cast<PFN_vkCmdEndRendering>(vkGetDeviceProcAddr(device, "vkCmdEndRenderingKHR"));
+			for (auto& i : memoryWatermarkLevels)
+				i = 0;
+			UpdateMemoryBudget();
 			// 输出所用的物理设备的名称
 			outStream << std::format("Renderer: {}\n", physicalDeviceProperties.deviceName);
 			return VK_SUCCESS;
@@ -701,12 +1226,15 @@ namespace vulkan {
 			}
 			// Set image count, swap chain中的image数量最好不要太少，避免阻塞，同时不要太多，避免占用过多显存
 			swapchainCreateInfo.minImageCount = surfaceCapabilities.minImageCount + (surfaceCapabilities.maxImageCount > surfaceCapabilities.minImageCount);
-			// Set image extent, 设置image尺寸
+			if (swapchainImageCountHint)
+				swapchainCreateInfo.minImageCount = glm::clamp(swapchainImageCountHint, surfaceCapabilities.minImageCount,
+					surfaceCapabilities.maxImageCount ? surfaceCapabilities.maxImageCount : UINT32_MAX);
+			// Set image extent, 设置image尺寸, surface不限定尺寸时（currentExtent为特殊值0xFFFFFFFF）使用swapchainExtentHint
 			swapchainCreateInfo.imageExtent =
 				surfaceCapabilities.currentExtent.width == -1 ?
 				VkExtent2D{
-				glm::clamp(defaultWindowSize.width, surfaceCapabilities.minImageExtent.width, surfaceCapabilities.maxImageExtent.width),
-				glm::clamp(defaultWindowSize.height, surfaceCapabilities.minImageExtent.height, surfaceCapabilities.maxImageExtent.height) } :
+				glm::clamp(swapchainExtentHint.width, surfaceCapabilities.minImageExtent.width, surfaceCapabilities.maxImageExtent.width),
+				glm::clamp(swapchainExtentHint.height, surfaceCapabilities.minImageExtent.height, surfaceCapabilities.maxImageExtent.height) } :
 				surfaceCapabilities.currentExtent;
 			// Set transformation
 			swapchainCreateInfo.preTransform = surfaceCapabilities.currentTransform;
@@ -783,6 +1311,98 @@ namespace vulkan {
 			return VK_SUCCESS;
 		}
 
+		// 无窗口渲染时代替交换链, 创建imageCount张离屏颜色图像, 其用法与交换链图像相同（SwapchainImage(...)、SwapchainImageView(...)、SwapImage(...)、PresentImage(...)）
+		// 再次调用时会先销毁先前的离屏图像, 可用于改变渲染尺寸
+		result_t CreateOffscreenSwapchain(VkExtent2D extent, uint32_t imageCount = 3, VkFormat format = VK_FORMAT_R8G8B8A8_UNORM) {
+			if (swapchain) {
+				outStream << std::format("[ graphicsBase ] ERROR\nCannot create offscreen images when a swapchain exists!\n");
+				return VK_RESULT_MAX_ENUM;
+			}
+			if (IsOffscreen()) {
+				if (VkResult result = WaitIdle())
+					return result;
+				for (auto& i : callbacks_destroySwapchain)
+					i();
+				for (auto& i : swapchainImageViews)
+					if (i)
+						vkDestroyImageView(device, i, nullptr);
+				swapchainImageViews.resize(0);
+				DestroyOffscreenImages_Internal();
+			}
+			swapchainCreateInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+			swapchainCreateInfo.minImageCount = imageCount;
+			swapchainCreateInfo.imageFormat = format;
+			swapchainCreateInfo.imageColorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+			swapchainCreateInfo.imageExtent = extent;
+			swapchainCreateInfo.imageArrayLayers = 1;
+			// 能被用作transfer_src以便读回渲染结果
+			swapchainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+			swapchainCreateInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			VkImageCreateInfo imageCreateInfo = {
+				.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+				.imageType = VK_IMAGE_TYPE_2D,
+				.format = format,
+				.extent = { extent.width, extent.height, 1 },
+				.mipLevels = 1,
+				.arrayLayers = 1,
+				.samples = VK_SAMPLE_COUNT_1_BIT,
+				.tiling = VK_IMAGE_TILING_OPTIMAL,
+				.usage = swapchainCreateInfo.imageUsage,
+				.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+			};
+			swapchainImages.assign(imageCount, VK_NULL_HANDLE);
+			offscreenImageMemories.assign(imageCount, VK_NULL_HANDLE);
+			// 失败时销毁本次已创建的image view、图像和内存（销毁VK_NULL_HANDLE无效果）, 使IsOffscreen()为false
+			auto DestroyCreated = [this] {
+				for (auto& i : swapchainImageViews)
+					if (i)
+						vkDestroyImageView(device, i, nullptr);
+				swapchainImageViews.resize(0);
+				DestroyOffscreenImages_Internal();
+				};
+			for (uint32_t i = 0; i < imageCount; i++) {
+				if (VkResult result = vkCreateImage(device, &imageCreateInfo, nullptr, &swapchainImages[i])) {
+					outStream << std::format("[ graphicsBase ] ERROR\nFailed to create an offscreen image!\nError code: {}\n", int32_t(result));
+					DestroyCreated();
+					return result;
+				}
+				VkMemoryRequirements memoryRequirements;
+				vkGetImageMemoryRequirements(device, swapchainImages[i], &memoryRequirements);
+				VkMemoryAllocateInfo memoryAllocateInfo = {
+					.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+					.allocationSize = memoryRequirements.size,
+					.memoryTypeIndex = UINT32_MAX
+				};
+				// 优先选择设备本地的内存类型
+				for (uint32_t j = 0; j < physicalDeviceMemoryProperties.memoryTypeCount; j++)
+					if (memoryRequirements.memoryTypeBits & 1 << j &&
+						(memoryAllocateInfo.memoryTypeIndex == UINT32_MAX ||
+						physicalDeviceMemoryProperties.memoryTypes[j].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) {
+						memoryAllocateInfo.memoryTypeIndex = j;
+						if (physicalDeviceMemoryProperties.memoryTypes[j].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+							break;
+					}
+				if (VkResult result = vkAllocateMemory(device, &memoryAllocateInfo, nullptr, &offscreenImageMemories[i])) {
+					outStream << std::format("[ graphicsBase ] ERROR\nFailed to allocate memory for an offscreen image!\nError code: {}\n", int32_t(result));
+					DestroyCreated();
+					return result;
+				}
+				if (VkResult result = vkBindImageMemory(device, swapchainImages[i], offscreenImageMemories[i], 0)) {
+					outStream << std::format("[ graphicsBase ] ERROR\nFailed to bind memory to an offscreen image!\nError code: {}\n", int32_t(result));
+					DestroyCreated();
+					return result;
+				}
+			}
+			if (VkResult result = CreateSwapchainImageViews_Internal()) {
+				DestroyCreated();
+				return result;
+			}
+			currentImageIndex = 0;
+			for (auto& i : callbacks_createSwapchain)
+				i();
+			return VK_SUCCESS;
+		}
+
 		// After initialization
 		void Terminate() {
 			this->~graphicsBase();
@@ -793,8 +1413,14 @@ namespace vulkan {
 			swapchain = VK_NULL_HANDLE;
 			swapchainImages.resize(0);
 			swapchainImageViews.resize(0);
+			offscreenImageMemories.resize(0);
+			swapchainImageFences.resize(0);
+			swapchainImageFencesTracked = false;
+			swapchainRecreationPending = false;
+			frameNumber = completedFrameNumber = 0;
 			swapchainCreateInfo = {};
 			debugUtilsMessenger = VK_NULL_HANDLE;
+			pipelineCache = VK_NULL_HANDLE;
 		}
 
 		// 重建逻辑设备
@@ -802,7 +1428,7 @@ namespace vulkan {
 			// 等待逻辑设备空闲
 			if (VkResult result = WaitIdle())
 				return result;
-			if (swapchain) {
+			if (swapchain || IsOffscreen()) {
 				// 调用销毁交换链时的回调函数
 				for (auto& i : callbacks_destroySwapchain)
 					i();
@@ -811,12 +1437,17 @@ namespace vulkan {
 					if (i)
 						vkDestroyImageView(device, i, nullptr);
 				swapchainImageViews.resize(0);
-				// 销毁swap chain
-				vkDestroySwapchainKHR(device, swapchain, nullptr);
+				// 销毁swap chain或离屏图像
+				if (swapchain)
+					vkDestroySwapchainKHR(device, swapchain, nullptr);
+				DestroyOffscreenImages_Internal();
 				// 重置
 				swapchain = VK_NULL_HANDLE;
 				swapchainCreateInfo = {};
+				swapchainRecreationPending = false;
 			}
+			DestroyRetiredSwapchains_Internal(true);
+			DestroyDeferred_Internal(true);
 			for (auto& i : callbacks_destroyDevice)
 				i();
 			if (device)
@@ -827,6 +1458,9 @@ namespace vulkan {
 
 		// 在开关HDR或改变窗口大小时需要重建swap chain
 		result_t RecreateSwapchain() {
+			// 离屏图像的尺寸只由CreateOffscreenSwapchain(...)改变
+			if (IsOffscreen())
+				return VK_SUCCESS;
 			VkSurfaceCapabilitiesKHR surfaceCapabilities = {};
 			if (VkResult result = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, surface, &surfaceCapabilities)) {
 				outStream << std::format("[ graphicsBase ] ERROR\nFailed to get physical device surface capabilities!\nError code: {}\n", int32_t(result));
@@ -836,25 +1470,52 @@ namespace vulkan {
 			if (surfaceCapabilities.currentExtent.width == 0 ||
 				surfaceCapabilities.currentExtent.height == 0)
 				return VK_SUCCESS;
-			swapchainCreateInfo.imageExtent = surfaceCapabilities.currentExtent;
-			swapchainCreateInfo.oldSwapchain = swapchain;
-			// 保程序没有正在使用旧的交换链, 等待图形和呈现队列闲置
-			VkResult result = vkQueueWaitIdle(queue_graphics);
-			if (!result &&
-				queue_graphics != queue_presentation)
-				result = vkQueueWaitIdle(queue_presentation);
+			// surface不限定尺寸时保持原有尺寸
+			if (surfaceCapabilities.currentExtent.width != -1)
+				swapchainCreateInfo.imageExtent = surfaceCapabilities.currentExtent;
+			swapchainRecreationPending = false;
+			// 未登记栅栏时无从得知哪些命令仍在使用旧交换链的图像, 只得等待图形和呈现队列闲置
+			if (!swapchainImageFencesTracked) {
+				VkResult result = vkQueueWaitIdle(queue_graphics);
+				if (!result &&
+					queue_graphics != queue_presentation)
+					result = vkQueueWaitIdle(queue_presentation);
+				if (result) {
+					outStream << std::format("[ graphicsBase ] ERROR\nFailed to wait for the queue to be idle!\nError code: {}\n", int32_t(result));
+					return result;
+				}
+			}
+
+			// 先创建新交换链, 旧交换链随之退役（retired）但仍可呈现已获取的图像, 创建失败时保留旧交换链的图像及相关对象
+			VkSwapchainKHR oldSwapchain = swapchain;
+			swapchainCreateInfo.oldSwapchain = oldSwapchain;
+			VkResult result = vkCreateSwapchainKHR(device, &swapchainCreateInfo, nullptr, &swapchain);
+			swapchainCreateInfo.oldSwapchain = VK_NULL_HANDLE;
 			if (result) {
-				outStream << std::format("[ graphicsBase ] ERROR\nFailed to wait for the queue to be idle!\nError code: {}\n", int32_t(result));
+				swapchain = oldSwapchain;
+				outStream << std::format("[ graphicsBase ] ERROR\nFailed to recreate a swapchain!\nError code: {}\n", int32_t(result));
 				return result;
 			}
-
+			retiredSwapchains.push_back({ oldSwapchain });
+
+			// 只等待仍在写入旧交换链图像的命令, 即至多等待各即时帧, 然后销毁依赖于旧交换链图像的对象
+			std::vector<VkFence> fences;
+			for (auto& i : swapchainImageFences)
+				if (i &&
+					std::find(fences.begin(), fences.end(), i) == fences.end())
+					fences.push_back(i);
+			if (fences.size())
+				if (result = vkWaitForFences(device, uint32_t(fences.size()), fences.data(), VK_TRUE, UINT64_MAX)) {
+					outStream << std::format("[ graphicsBase ] ERROR\nFailed to wait for the fences of swapchain images!\nError code: {}\n", int32_t(result));
+					return result;
+				}
 			for (auto& i : callbacks_destroySwapchain)
 				i();
 			for (auto& i : swapchainImageViews)
 				if (i)
 					vkDestroyImageView(device, i, nullptr);
 			swapchainImageViews.resize(0);
-			if (result = CreateSwapchain_Internal())
+			if (result = GetSwapchainImages_Internal())
 				return result;
 			for (auto& i : callbacks_createSwapchain)
 				i();
@@ -863,16 +1524,36 @@ namespace vulkan {
 
 		// 用于获取交换链图像索引到currentImageIndex，以及在需要重建交换链时调用RecreateSwapchain()、重建交换链后销毁旧交换链
 		result_t SwapImage(VkSemaphore semaphore_imageIsAvailable) {
-			// 销毁旧swap chain, 逻辑是如果在当前帧重建交换链，那么在下一帧销毁交换链
-			if (swapchainCreateInfo.oldSwapchain &&
-				swapchainCreateInfo.oldSwapchain != swapchain) {
-				vkDestroySwapchainKHR(device, swapchainCreateInfo.oldSwapchain, nullptr);
-				swapchainCreateInfo.oldSwapchain = VK_NULL_HANDLE;
+			// 离屏渲染时轮流使用各离屏图像, 以一次空提交置位信号量, 使渲染循环的同步方式与使用交换链时相同
+			if (IsOffscreen()) {
+				currentImageIndex = (currentImageIndex + 1) % uint32_t(swapchainImages.size());
+				if (!semaphore_imageIsAvailable)
+					return VK_SUCCESS;
+				VkSubmitInfo submitInfo = {
+					.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+					.signalSemaphoreCount = 1,
+					.pSignalSemaphores = &semaphore_imageIsAvailable
+				};
+				VkResult result = vkQueueSubmit(queue_graphics, 1, &submitInfo, VK_NULL_HANDLE);
+				if (result)
+					outStream << std::format("[ graphicsBase ] ERROR\nFailed to signal the semaphore for an offscreen image!\nError code: {}\n", int32_t(result));
+				return result;
 			}
+			// 销毁已不再被使用的旧交换链
+			DestroyRetiredSwapchains_Internal(false);
+			// 窗口尺寸已有一段时间未再变化时, 执行被推迟的重建
+			if (swapchainRecreationPending &&
+				std::chrono::steady_clock::now() - time_lastResize >= swapchainRecreationDelay)
+				if (VkResult result = RecreateSwapchain())
+					return result;
 			// 获取可用的swap chain图像索引
 			while (VkResult result = vkAcquireNextImageKHR(device, swapchain, UINT64_MAX, semaphore_imageIsAvailable, VK_NULL_HANDLE, &currentImageIndex))
 				switch (result) {
 				case VK_SUBOPTIMAL_KHR:
+					// 图像已被获取且仍可被呈现, 推迟重建交换链, 使连续的尺寸变化只引发一次重建
+					if (!swapchainRecreationPending)
+						NotifyResize();
+					return VK_SUCCESS;
 				case VK_ERROR_OUT_OF_DATE_KHR:
 					if (VkResult result = RecreateSwapchain())
 						return result;
@@ -920,6 +1601,12 @@ namespace vulkan {
 			return SubmitCommandBuffer_Graphics(submitInfo, fence);
 		}
 
+		// 等待和置位多个二值或时间线信号量的情形, 以时间线信号量表示帧序号时可不使用栅栏
+		result_t SubmitCommandBuffer_Graphics(VkCommandBuffer commandBuffer,
+			arrayRef<const semaphoreSubmitInfo> waitSemaphores, arrayRef<const semaphoreSubmitInfo> signalSemaphores, VkFence fence = VK_NULL_HANDLE) const {
+			return SubmitCommandBuffer_Internal(queue_graphics, commandBuffer, waitSemaphores, signalSemaphores, fence);
+		}
+
 		// 将command buffer提交到用于计算的队列, 只是用栅栏的情形
 		result_t SubmitCommandBuffer_Compute(VkSubmitInfo& submitInfo, VkFence fence = VK_NULL_HANDLE) const {
 			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -938,6 +1625,36 @@ namespace vulkan {
 			return SubmitCommandBuffer_Compute(submitInfo, fence);
 		}
 
+		// 将command buffer提交到用于计算的队列, 等待和置位多个二值或时间线信号量, 用于表达跨队列的依赖
+		result_t SubmitCommandBuffer_Compute(VkCommandBuffer commandBuffer,
+			arrayRef<const semaphoreSubmitInfo> waitSemaphores, arrayRef<const semaphoreSubmitInfo> signalSemaphores, VkFence fence = VK_NULL_HANDLE) const {
+			return SubmitCommandBuffer_Internal(queue_compute, commandBuffer, waitSemaphores, signalSemaphores, fence);
+		}
+
+		// 将command buffer提交到用于数据传送的队列（见Queue_Transfer()）, 只是用栅栏的情形
+		result_t SubmitCommandBuffer_Transfer(VkSubmitInfo& submitInfo, VkFence fence = VK_NULL_HANDLE) const {
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			VkResult result = vkQueueSubmit(Queue_Transfer(), 1, &submitInfo, fence);
+			if (result)
+				outStream << std::format("[ graphicsBase ] ERROR\nFailed to submit the command buffer!\nError code: {}\n", int32_t(result));
+			return result;
+		}
+
+		// 将command buffer提交到用于数据传送的队列
+		result_t SubmitCommandBuffer_Transfer(VkCommandBuffer commandBuffer, VkFence fence = VK_NULL_HANDLE) const {
+			VkSubmitInfo submitInfo = {
+				.commandBufferCount = 1,
+				.pCommandBuffers = &commandBuffer
+			};
+			return SubmitCommandBuffer_Transfer(submitInfo, fence);
+		}
+
+		// 将command buffer提交到用于数据传送的队列（见Queue_Transfer()）, 等待和置位多个二值或时间线信号量, 用于表达跨队列的依赖
+		result_t SubmitCommandBuffer_Transfer(VkCommandBuffer commandBuffer,
+			arrayRef<const semaphoreSubmitInfo> waitSemaphores, arrayRef<const semaphoreSubmitInfo> signalSemaphores, VkFence fence = VK_NULL_HANDLE) const {
+			return SubmitCommandBuffer_Internal(Queue_Transfer(), commandBuffer, waitSemaphores, signalSemaphores, fence);
+		}
+
 		// 将command buffer提交到用于计算的队列, 带需要等待的信号量，命令完成后需要置位的信号量和栅栏
 		result_t SubmitCommandBuffer_Presentation(VkCommandBuffer commandBuffer,
 			VkSemaphore semaphore_renderingIsOver = VK_NULL_HANDLE, VkSemaphore semaphore_ownershipIsTransfered = VK_NULL_HANDLE, VkFence fence = VK_NULL_HANDLE) const {
@@ -960,6 +1677,12 @@ namespace vulkan {
 			return result;
 		}
 
+		// 将command buffer提交到用于呈现的队列, 等待和置位多个二值或时间线信号量
+		result_t SubmitCommandBuffer_Presentation(VkCommandBuffer commandBuffer,
+			arrayRef<const semaphoreSubmitInfo> waitSemaphores, arrayRef<const semaphoreSubmitInfo> signalSemaphores, VkFence fence = VK_NULL_HANDLE) const {
+			return SubmitCommandBuffer_Internal(queue_presentation, commandBuffer, waitSemaphores, signalSemaphores, fence);
+		}
+
 		void CmdTransferImageOwnership(VkCommandBuffer commandBuffer) const {
 			VkImageMemoryBarrier imageMemoryBarrier_g2p = {
 				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
@@ -977,11 +1700,31 @@ namespace vulkan {
 		}
 
 		result_t PresentImage(VkPresentInfoKHR& presentInfo) {
+			// 离屏渲染时不呈现, 但须以一次空提交等待（即消耗）信号量, 以便下一帧再次置位它
+			if (IsOffscreen()) {
+				if (!presentInfo.waitSemaphoreCount)
+					return VK_SUCCESS;
+				std::vector<VkPipelineStageFlags> waitDstStages(presentInfo.waitSemaphoreCount, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+				VkSubmitInfo submitInfo = {
+					.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+					.waitSemaphoreCount = presentInfo.waitSemaphoreCount,
+					.pWaitSemaphores = presentInfo.pWaitSemaphores,
+					.pWaitDstStageMask = waitDstStages.data()
+				};
+				VkResult result = vkQueueSubmit(queue_graphics, 1, &submitInfo, VK_NULL_HANDLE);
+				if (result)
+					outStream << std::format("[ graphicsBase ] ERROR\nFailed to wait for the semaphore of an offscreen image!\nError code: {}\n", int32_t(result));
+				return result;
+			}
 			presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 			switch (VkResult result = vkQueuePresentKHR(queue_presentation, &presentInfo)) {
 			case VK_SUCCESS:
 				return VK_SUCCESS;
 			case VK_SUBOPTIMAL_KHR:
+				// 图像已被呈现, 推迟重建交换链
+				if (!swapchainRecreationPending)
+					NotifyResize();
+				return VK_SUCCESS;
 			case VK_ERROR_OUT_OF_DATE_KHR:
 				return RecreateSwapchain();
 			default:
@@ -1032,6 +1775,8 @@ namespace vulkan {
 
 		DefineAddressFunction;
 
+		DefineDeferredDestroyFunction(vkDestroySemaphore);
+
 		//Non-const Function
 		result_t Create(VkSemaphoreCreateInfo& createInfo) {
 			createInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -1046,9 +1791,96 @@ namespace vulkan {
 		}
 	};
 
+	// 时间线信号量, 其值单调递增, 既可在队列间同步, 也可在CPU一侧等待或置位, 需要Vulkan1.2的timelineSemaphore特性
+	class timelineSemaphore {
+		VkSemaphore handle = VK_NULL_HANDLE;
+	public:
+		timelineSemaphore(uint64_t initialValue = 0) {
+			Create(initialValue);
+		}
+
+		timelineSemaphore(timelineSemaphore&& other) noexcept { MoveHandle; }
+
+		~timelineSemaphore() { DestroyHandleBy(vkDestroySemaphore); }
+
+		//Getter
+		DefineHandleTypeOperator;
+
+		DefineAddressFunction;
+
+		DefineDeferredDestroyFunction(vkDestroySemaphore);
+
+		//Const Function
+		// 在CPU一侧等待信号量的值达到value, 超时返回VK_TIMEOUT
+		result_t Wait(uint64_t value, uint64_t timeout = UINT64_MAX) const {
+			VkSemaphoreWaitInfo waitInfo = {
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+				.semaphoreCount = 1,
+				.pSemaphores = &handle,
+				.pValues = &value
+			};
+			VkResult result = vkWaitSemaphores(graphicsBase::Base().Device(), &waitInfo, timeout);
+			if (result < 0)
+				outStream << std::format("[ timelineSemaphore ] ERROR\nFailed to wait for the timeline semaphore!\nError code: {}\n", int32_t(result));
+			return result;
+		}
+
+		// 在CPU一侧将信号量的值设为value, value须大于当前值
+		result_t Signal(uint64_t value) const {
+			VkSemaphoreSignalInfo signalInfo = {
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO,
+				.semaphore = handle,
+				.value = value
+			};
+			VkResult result = vkSignalSemaphore(graphicsBase::Base().Device(), &signalInfo);
+			if (result)
+				outStream << std::format("[ timelineSemaphore ] ERROR\nFailed to signal the timeline semaphore!\nError code: {}\n", int32_t(result));
+			return result;
+		}
+
+		result_t Value(uint64_t& value) const {
+			VkResult result = vkGetSemaphoreCounterValue(graphicsBase::Base().Device(), handle, &value);
+			if (result)
+				outStream << std::format("[ timelineSemaphore ] ERROR\nFailed to get the value of the timeline semaphore!\nError code: {}\n", int32_t(result));
+			return result;
+		}
+
+		uint64_t Value() const {
+			uint64_t value = 0;
+			Value(value);
+			return value;
+		}
+
+		//Non-const Function
+		result_t Create(uint64_t initialValue = 0) {
+			VkSemaphoreTypeCreateInfo semaphoreTypeCreateInfo = {
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+				.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+				.initialValue = initialValue
+			};
+			VkSemaphoreCreateInfo createInfo = {
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+				.pNext = &semaphoreTypeCreateInfo
+			};
+			VkResult result = vkCreateSemaphore(graphicsBase::Base().Device(), &createInfo, nullptr, &handle);
+			if (result)
+				outStream << std::format("[ timelineSemaphore ] ERROR\nFailed to create a timeline semaphore!\nError code: {}\n", int32_t(result));
+			return result;
+		}
+	};
+
 	// 栅栏用于在cpu(app)侧和队列之间进行同步
 	class fence {
 		VkFence handle = VK_NULL_HANDLE;
+		// 被WaitAll和WaitAny调用, 以单次vkWaitForFences等待多个栅栏
+		static result_t Wait_Internal(arrayRef<const VkFence> fences, VkBool32 waitAll, uint64_t timeout) {
+			if (!fences.Count())
+				return VK_SUCCESS;
+			VkResult result = vkWaitForFences(graphicsBase::Base().Device(), uint32_t(fences.Count()), fences.Pointer(), waitAll, timeout);
+			if (result < 0)
+				outStream << std::format("[ fence ] ERROR\nFailed to wait for the fences!\nError code: {}\n", int32_t(result));
+			return result;
+		}
 	public:
 		// fence() = default;
 		fence(VkFenceCreateInfo& createInfo) {
@@ -1069,6 +1901,8 @@ namespace vulkan {
 
 		DefineAddressFunction;
 
+		DefineDeferredDestroyFunction(vkDestroyFence);
+
 		// Const Function
 		// 等待当前栅栏被置位
 		result_t Wait() const {
@@ -1116,6 +1950,148 @@ namespace vulkan {
 			};
 			return Create(createInfo);
 		}
+
+		//Static Function
+		// 等待所有栅栏被置位, 超时返回VK_TIMEOUT
+		static result_t WaitAll(arrayRef<const VkFence> fences, uint64_t timeout = UINT64_MAX) {
+			return Wait_Internal(fences, VK_TRUE, timeout);
+		}
+		static result_t WaitAll(arrayRef<const fence> fences, uint64_t timeout = UINT64_MAX) {
+			return Wait_Internal({ fences.Count() ? fences[0].Address() : nullptr, fences.Count() }, VK_TRUE, timeout);
+		}
+
+		// 等待任一栅栏被置位, 超时返回VK_TIMEOUT
+		static result_t WaitAny(arrayRef<const VkFence> fences, uint64_t timeout = UINT64_MAX) {
+			return Wait_Internal(fences, VK_FALSE, timeout);
+		}
+		static result_t WaitAny(arrayRef<const fence> fences, uint64_t timeout = UINT64_MAX) {
+			return Wait_Internal({ fences.Count() ? fences[0].Address() : nullptr, fences.Count() }, VK_FALSE, timeout);
+		}
+	};
+	// WaitAll(...)和WaitAny(...)将fence的数组视作VkFence的数组
+	static_assert(sizeof(fence) == sizeof(VkFence));
+
+	// 同步对象池, 复用未置位的栅栏和二值信号量, 以免每次使用都调用vkCreate*和vkDestroy*
+	// 用法：AcquireFence()/AcquireSemaphore()取得同步对象, 提交后以RecycleOnRetire(...)登记, 每帧调用Update()回收已完成的提交所用的同步对象
+	class syncObjectPool {
+		struct pendingSubmission {
+			VkFence fence;
+			bool recycleFence;
+			std::vector<VkSemaphore> semaphores;
+		};
+		// 池所拥有的全部handle, 在析构时销毁
+		std::vector<VkFence> fences;
+		std::vector<VkSemaphore> semaphores;
+		// 当前可分配的handle
+		std::vector<VkFence> availableFences;
+		std::vector<VkSemaphore> availableSemaphores;
+		std::vector<pendingSubmission> pendingSubmissions;
+		std::vector<VkFence> fencesToReset;
+	public:
+		syncObjectPool() = default;
+		syncObjectPool(syncObjectPool&&) = delete;
+		~syncObjectPool() {
+			if (fences.empty() && semaphores.empty())
+				return;
+			WaitAll();
+			for (auto& i : fences)
+				vkDestroyFence(graphicsBase::Base().Device(), i, nullptr);
+			for (auto& i : semaphores)
+				vkDestroySemaphore(graphicsBase::Base().Device(), i, nullptr);
+		}
+		//Getter
+		uint32_t FenceCount() const {
+			return uint32_t(fences.size());
+		}
+		uint32_t SemaphoreCount() const {
+			return uint32_t(semaphores.size());
+		}
+		uint32_t PendingSubmissionCount() const {
+			return uint32_t(pendingSubmissions.size());
+		}
+		//Non-const Function
+		// 取得一个未置位的栅栏, 池中没有可用的栅栏时才创建新的
+		VkFence AcquireFence() {
+			if (availableFences.size()) {
+				VkFence fence = availableFences.back();
+				availableFences.pop_back();
+				return fence;
+			}
+			VkFenceCreateInfo createInfo = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+			VkFence fence = VK_NULL_HANDLE;
+			if (VkResult result = vkCreateFence(graphicsBase::Base().Device(), &createInfo, nullptr, &fence)) {
+				outStream << std::format("[ syncObjectPool ] ERROR\nFailed to create a fence!\nError code: {}\n", int32_t(result));
+				return VK_NULL_HANDLE;
+			}
+			fences.push_back(fence);
+			return fence;
+		}
+		// 取得一个未置位且没有待执行的等待操作的二值信号量
+		VkSemaphore AcquireSemaphore() {
+			if (availableSemaphores.size()) {
+				VkSemaphore semaphore = availableSemaphores.back();
+				availableSemaphores.pop_back();
+				return semaphore;
+			}
+			VkSemaphoreCreateInfo createInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+			VkSemaphore semaphore = VK_NULL_HANDLE;
+			if (VkResult result = vkCreateSemaphore(graphicsBase::Base().Device(), &createInfo, nullptr, &semaphore)) {
+				outStream << std::format("[ syncObjectPool ] ERROR\nFailed to create a semaphore!\nError code: {}\n", int32_t(result));
+				return VK_NULL_HANDLE;
+			}
+			semaphores.push_back(semaphore);
+			return semaphore;
+		}
+		// 登记一次提交, fence被置位后回收semaphores, 若recycleFence为true则fence本身也被重置并回收（此时fence须取自本池）
+		// 信号量须在等待它的提交完成后才能回收, 因此应当以等待该信号量的那次提交的栅栏来登记
+		void RecycleOnRetire(VkFence fence, arrayRef<const VkSemaphore> semaphores = {}, bool recycleFence = true) {
+			pendingSubmissions.push_back({ fence, recycleFence, std::vector<VkSemaphore>(semaphores.begin(), semaphores.end()) });
+		}
+		// 回收未曾用于提交的信号量
+		void ReleaseUnusedSemaphore(VkSemaphore semaphore) {
+			availableSemaphores.push_back(semaphore);
+		}
+		// 查询已登记的提交是否完成, 以单次vkResetFences批量重置已置位的栅栏, 并回收相应的同步对象
+		result_t Update() {
+			for (size_t i = 0; i < pendingSubmissions.size();) {
+				VkResult result = vkGetFenceStatus(graphicsBase::Base().Device(), pendingSubmissions[i].fence);
+				if (result < 0) {
+					outStream << std::format("[ syncObjectPool ] ERROR\nFailed to get the status of the fence!\nError code: {}\n", int32_t(result));
+					return result;
+				}
+				if (result == VK_NOT_READY) {
+					i++;
+					continue;
+				}
+				auto& submission = pendingSubmissions[i];
+				if (submission.recycleFence)
+					fencesToReset.push_back(submission.fence);
+				availableSemaphores.insert(availableSemaphores.end(), submission.semaphores.begin(), submission.semaphores.end());
+				// 与末尾元素交换后移除, 登记顺序无关紧要
+				submission = std::move(pendingSubmissions.back());
+				pendingSubmissions.pop_back();
+			}
+			if (fencesToReset.empty())
+				return VK_SUCCESS;
+			if (VkResult result = vkResetFences(graphicsBase::Base().Device(), uint32_t(fencesToReset.size()), fencesToReset.data())) {
+				outStream << std::format("[ syncObjectPool ] ERROR\nFailed to reset the fences!\nError code: {}\n", int32_t(result));
+				return result;
+			}
+			availableFences.insert(availableFences.end(), fencesToReset.begin(), fencesToReset.end());
+			fencesToReset.clear();
+			return VK_SUCCESS;
+		}
+		// 等待所有已登记的提交完成并回收
+		result_t WaitAll() {
+			if (pendingSubmissions.empty())
+				return VK_SUCCESS;
+			std::vector<VkFence> pendingFences(pendingSubmissions.size());
+			for (size_t i = 0; i < pendingSubmissions.size(); i++)
+				pendingFences[i] = pendingSubmissions[i].fence;
+			if (VkResult result = fence::WaitAll({ pendingFences.data(), pendingFences.size() }))
+				return result;
+			return Update();
+		}
 	};
 
 	// 着色器模组
@@ -1145,6 +2121,8 @@ namespace vulkan {
 
 		DefineAddressFunction;
 
+		DefineDeferredDestroyFunction(vkDestroyShaderModule);
+
 		//Const Function
 		VkPipelineShaderStageCreateInfo StageCreateInfo(VkShaderStageFlagBits stage, const char* entry = "main") const {
 			return {
@@ -1209,6 +2187,8 @@ namespace vulkan {
 
 		DefineAddressFunction;
 
+		DefineDeferredDestroyFunction(vkDestroyPipelineLayout);
+
 		//Non-const Function
 		result_t Create(VkPipelineLayoutCreateInfo& createInfo) {
 			createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -1219,45 +2199,187 @@ namespace vulkan {
 		}
 	};
 
-	// 管线
-	class pipeline {
-		VkPipeline handle = VK_NULL_HANDLE;
+	// 管线缓存, 可从磁盘读取先前保存的数据, 以免每次启动都从头编译管线
+	class pipelineCache {
+		VkPipelineCache handle = VK_NULL_HANDLE;
 	public:
-		pipeline() = default;
+		pipelineCache() = default;
 
-		pipeline(VkGraphicsPipelineCreateInfo& createInfo) {
+		pipelineCache(VkPipelineCacheCreateInfo& createInfo) {
 			Create(createInfo);
 		}
 
-		pipeline(VkComputePipelineCreateInfo& createInfo) {
-			Create(createInfo);
+		pipelineCache(const char* filepath) {
+			Create(filepath);
+		}
+
+		pipelineCache(pipelineCache&& other) noexcept { MoveHandle; }
+
+		~pipelineCache() { DestroyHandleBy(vkDestroyPipelineCache); }
+
+		//Getter
+		DefineHandleTypeOperator;
+
+		DefineAddressFunction;
+
+		DefineDeferredDestroyFunction(vkDestroyPipelineCache);
+
+		//Const Function
+		result_t GetData(std::vector<uint8_t>& data) const {
+			size_t dataSize = 0;
+			if (VkResult result = vkGetPipelineCacheData(graphicsBase::Base().Device(), handle, &dataSize, nullptr)) {
+				outStream << std::format("[ pipelineCache ] ERROR\nFailed to get the size of pipeline cache data!\nError code: {}\n", int32_t(result));
+				return result;
+			}
+			data.resize(dataSize);
+			VkResult result = vkGetPipelineCacheData(graphicsBase::Base().Device(), handle, &dataSize, data.data());
+			// 两次调用之间缓存可能被其他线程扩充, 此时返回VK_INCOMPLETE, 已取得的数据仍然有效
+			if (result < 0)
+				outStream << std::format("[ pipelineCache ] ERROR\nFailed to get pipeline cache data!\nError code: {}\n", int32_t(result));
+			data.resize(dataSize);
+			return result < 0 ? result : VK_SUCCESS;
+		}
+
+		// 将其他管线缓存（如各工作线程各自创建的缓存）合并到该缓存
+		result_t Merge(arrayRef<const VkPipelineCache> srcCaches) const {
+			VkResult result = vkMergePipelineCaches(graphicsBase::Base().Device(), handle, uint32_t(srcCaches.Count()), srcCaches.Pointer());
+			if (result)
+				outStream << std::format("[ pipelineCache ] ERROR\nFailed to merge pipeline caches!\nError code: {}\n", int32_t(result));
+			return result;
+		}
+
+		// 先写入临时文件再重命名, 使程序中途退出时不会留下不完整的缓存文件
+		result_t Save(const char* filepath) const {
+			std::vector<uint8_t> data;
+			if (VkResult result = GetData(data))
+				return result;
+			std::filesystem::path path = filepath;
+			std::filesystem::path tempPath = path;
+			tempPath += ".tmp";
+			{
+				std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+				if (!file ||
+					!file.write(reinterpret_cast<const char*>(data.data()), std::streamsize(data.size()))) {
+					outStream << std::format("[ pipelineCache ] ERROR\nFailed to write the file: {}\n", tempPath.string());
+					return VK_RESULT_MAX_ENUM;
+				}
+			}
+			std::error_code errorCode;
+			std::filesystem::rename(tempPath, path, errorCode);
+			if (errorCode) {
+				outStream << std::format("[ pipelineCache ] ERROR\nFailed to rename {} to {}!\nError message: {}\n", tempPath.string(), filepath, errorCode.message());
+				std::filesystem::remove(tempPath, errorCode);
+				return VK_RESULT_MAX_ENUM;
+			}
+			return VK_SUCCESS;
+		}
+
+		//Non-const Function
+		result_t Create(VkPipelineCacheCreateInfo& createInfo) {
+			createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+			VkResult result = vkCreatePipelineCache(graphicsBase::Base().Device(), &createInfo, nullptr, &handle);
+			if (result)
+				outStream << std::format("[ pipelineCache ] ERROR\nFailed to create a pipeline cache!\nError code: {}\n", int32_t(result));
+			return result;
+		}
+
+		result_t Create(const void* pInitialData = nullptr, size_t initialDataSize = 0, VkPipelineCacheCreateFlags flags = 0) {
+			VkPipelineCacheCreateInfo createInfo = {
+				.flags = flags,
+				.initialDataSize = initialDataSize,
+				.pInitialData = pInitialData
+			};
+			return Create(createInfo);
+		}
+
+		// 从文件读取初始数据, 文件不存在或与当前物理设备不兼容时创建空的管线缓存
+		result_t Create(const char* filepath, VkPipelineCacheCreateFlags flags = 0) {
+			std::vector<uint8_t> data;
+			std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+			if (file) {
+				data.resize(size_t(file.tellg()));
+				file.seekg(0);
+				if (!file.read(reinterpret_cast<char*>(data.data()), std::streamsize(data.size())))
+					data.clear();
+			}
+			if (data.size() &&
+				!IsCompatible(data.data(), data.size())) {
+				outStream << std::format("[ pipelineCache ] WARNING\nPipeline cache data in {} is invalid or was created by another device or driver, ignored.\n", filepath);
+				data.clear();
+			}
+			return Create(data.data(), data.size(), flags);
+		}
+
+		//Static Function
+		// 检查管线缓存数据的头部是否与当前物理设备一致, 驱动虽然也会拒绝不兼容的数据, 但并非所有驱动都能可靠地处理损坏的数据
+		static bool IsCompatible(const void* pData, size_t dataSize) {
+			VkPipelineCacheHeaderVersionOne header;
+			if (dataSize < sizeof header)
+				return false;
+			memcpy(&header, pData, sizeof header);
+			auto& properties = graphicsBase::Base().PhysicalDeviceProperties();
+			return header.headerSize >= sizeof header &&
+				header.headerSize <= dataSize &&
+				header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+				header.vendorID == properties.vendorID &&
+				header.deviceID == properties.deviceID &&
+				!memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+		}
+	};
+
+	// 管线
+	class pipeline {
+		VkPipeline handle = VK_NULL_HANDLE;
+	public:
+		pipeline() = default;
+
+		pipeline(VkGraphicsPipelineCreateInfo& createInfo, VkPipelineCache pipelineCache = graphicsBase::Base().PipelineCache()) {
+			Create(createInfo, pipelineCache);
+		}
+
+		pipeline(VkComputePipelineCreateInfo& createInfo, VkPipelineCache pipelineCache = graphicsBase::Base().PipelineCache()) {
+			Create(createInfo, pipelineCache);
 		}
 
 		pipeline(pipeline&& other) noexcept { MoveHandle; }
 
-		~pipeline() { DestroyHandleBy(vkDestroyPipeline); }
+		~pipeline() { DestroyHandleBy(Destroy_Internal); }
 
 		//Getter
 		DefineHandleTypeOperator;
 
 		DefineAddressFunction;
 
+		DefineDeferredDestroyFunction(Destroy_Internal);
+
 		//Non-const Function
-		result_t Create(VkGraphicsPipelineCreateInfo& createInfo) {
+		// 默认使用graphicsBase的管线缓存, 未设置时为VK_NULL_HANDLE
+		result_t Create(VkGraphicsPipelineCreateInfo& createInfo, VkPipelineCache pipelineCache = graphicsBase::Base().PipelineCache()) {
 			createInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-			VkResult result = vkCreateGraphicsPipelines(graphicsBase::Base().Device(), VK_NULL_HANDLE, 1, &createInfo, nullptr, &handle);
+			VkResult result = vkCreateGraphicsPipelines(graphicsBase::Base().Device(), pipelineCache, 1, &createInfo, nullptr, &handle);
 			if (result)
 				outStream << std::format("[ pipeline ] ERROR\nFailed to create a graphics pipeline!\nError code: {}\n", int32_t(result));
+			else
+				graphicsBase::Base().CountResource(resourceType_pipeline, 1);
 			return result;
 		}
 
-		result_t Create(VkComputePipelineCreateInfo& createInfo) {
+		result_t Create(VkComputePipelineCreateInfo& createInfo, VkPipelineCache pipelineCache = graphicsBase::Base().PipelineCache()) {
 			createInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
-			VkResult result = vkCreateComputePipelines(graphicsBase::Base().Device(), VK_NULL_HANDLE, 1, &createInfo, nullptr, &handle);
+			VkResult result = vkCreateComputePipelines(graphicsBase::Base().Device(), pipelineCache, 1, &createInfo, nullptr, &handle);
 			if (result)
 				outStream << std::format("[ pipeline ] ERROR\nFailed to create a compute pipeline!\nError code: {}\n", int32_t(result));
+			else
+				graphicsBase::Base().CountResource(resourceType_pipeline, 1);
 			return result;
 		}
+
+		//Static Function
+		// 销毁管线并更新graphicsBase中的统计, 被析构函数和延迟销毁调用
+		static void Destroy_Internal(VkDevice device, VkPipeline pipeline, const VkAllocationCallbacks* pAllocator) {
+			vkDestroyPipeline(device, pipeline, pAllocator);
+			graphicsBase::Base().CountResource(resourceType_pipeline, -1);
+		}
 	};
 
 	// 渲染通道
@@ -1279,6 +2401,8 @@ namespace vulkan {
 
 		DefineAddressFunction;
 
+		DefineDeferredDestroyFunction(vkDestroyRenderPass);
+
 		//Const Function, 开始渲染通道
 		void CmdBegin(VkCommandBuffer commandBuffer, VkRenderPassBeginInfo& beginInfo, VkSubpassContents subpassContents = VK_SUBPASS_CONTENTS_INLINE) const {
 			beginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -1337,6 +2461,8 @@ namespace vulkan {
 
 		DefineAddressFunction;
 
+		DefineDeferredDestroyFunction(vkDestroyFramebuffer);
+
 		//Non-const Function
 		result_t Create(VkFramebufferCreateInfo& createInfo) {
 			createInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
@@ -1408,13 +2534,15 @@ namespace vulkan {
 
 		commandPool(commandPool&& other) noexcept { MoveHandle; }
 
-		~commandPool() { DestroyHandleBy(vkDestroyCommandPool); }
+		~commandPool() { DestroyHandleBy(Destroy_Internal); }
 
 		//Getter
 		DefineHandleTypeOperator;
 
 		DefineAddressFunction;
 
+		DefineDeferredDestroyFunction(Destroy_Internal);
+
 		//Const Function, VK_COMMAND_BUFFER_LEVEL_PRIMARY为一级命令缓冲区
 		result_t AllocateBuffers(arrayRef<VkCommandBuffer> buffers, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY) const {
 			VkCommandBufferAllocateInfo allocateInfo = {
@@ -1444,12 +2572,23 @@ namespace vulkan {
 			FreeBuffers({ &buffers[0].handle, buffers.Count() });
 		}
 
+		// 将从该命令池分配的所有命令缓冲区重置为初始状态, 比逐个重置命令缓冲区更快, 调用前须确保这些命令缓冲区不在执行中
+		// flags为VK_COMMAND_POOL_RESET_RELEASE_RESOURCES_BIT时将内存归还给系统, 否则留待重用
+		result_t Reset(VkCommandPoolResetFlags flags = 0) const {
+			VkResult result = vkResetCommandPool(graphicsBase::Base().Device(), handle, flags);
+			if (result)
+				outStream << std::format("[ commandPool ] ERROR\nFailed to reset a command pool!\nError code: {}\n", int32_t(result));
+			return result;
+		}
+
 		//Non-const Function
 		result_t Create(VkCommandPoolCreateInfo& createInfo) {
 			createInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
 			VkResult result = vkCreateCommandPool(graphicsBase::Base().Device(), &createInfo, nullptr, &handle);
 			if (result)
 				outStream << std::format("[ commandPool ] ERROR\nFailed to create a command pool!\nError code: {}\n", int32_t(result));
+			else
+				graphicsBase::Base().CountResource(resourceType_commandPool, 1);
 			return result;
 		}
 
@@ -1460,6 +2599,1044 @@ namespace vulkan {
 			};
 			return Create(createInfo);
 		}
+
+		//Static Function
+		// 销毁命令池并更新graphicsBase中的统计, 被析构函数和延迟销毁调用
+		static void Destroy_Internal(VkDevice device, VkCommandPool commandPool, const VkAllocationCallbacks* pAllocator) {
+			vkDestroyCommandPool(device, commandPool, pAllocator);
+			graphicsBase::Base().CountResource(resourceType_commandPool, -1);
+		}
+	};
+
+	// 查询池, 用于时间戳、遮挡查询、管线统计查询等
+	class queryPool {
+		VkQueryPool handle = VK_NULL_HANDLE;
+	public:
+		queryPool() = default;
+
+		queryPool(VkQueryPoolCreateInfo& createInfo) {
+			Create(createInfo);
+		}
+
+		queryPool(VkQueryType queryType, uint32_t queryCount, VkQueryPipelineStatisticFlags pipelineStatistics = 0 /*reserved for future use*/) {
+			Create(queryType, queryCount, pipelineStatistics);
+		}
+
+		queryPool(queryPool&& other) noexcept { MoveHandle; }
+
+		~queryPool() { DestroyHandleBy(vkDestroyQueryPool); }
+
+		//Getter
+		DefineHandleTypeOperator;
+
+		DefineAddressFunction;
+
+		DefineDeferredDestroyFunction(vkDestroyQueryPool);
+
+		//Const Function
+		// 在命令缓冲区中重置查询, 须在渲染通道外录制
+		void CmdReset(VkCommandBuffer commandBuffer, uint32_t firstQueryIndex, uint32_t queryCount) const {
+			vkCmdResetQueryPool(commandBuffer, handle, firstQueryIndex, queryCount);
+		}
+
+		void CmdBegin(VkCommandBuffer commandBuffer, uint32_t queryIndex, VkQueryControlFlags flags = 0) const {
+			vkCmdBeginQuery(commandBuffer, handle, queryIndex, flags);
+		}
+
+		void CmdEnd(VkCommandBuffer commandBuffer, uint32_t queryIndex) const {
+			vkCmdEndQuery(commandBuffer, handle, queryIndex);
+		}
+
+		// 在指定的管线阶段完成后写入时间戳
+		void CmdWriteTimestamp(VkCommandBuffer commandBuffer, VkPipelineStageFlagBits pipelineStage, uint32_t queryIndex) const {
+			vkCmdWriteTimestamp(commandBuffer, pipelineStage, handle, queryIndex);
+		}
+
+		// 在命令缓冲区中将查询结果复制到缓冲区
+		void CmdCopyResults(VkCommandBuffer commandBuffer, uint32_t firstQueryIndex, uint32_t queryCount,
+			VkBuffer buffer_dst, VkDeviceSize offset_dst, VkDeviceSize stride, VkQueryResultFlags flags = 0) const {
+			vkCmdCopyQueryPoolResults(commandBuffer, handle, firstQueryIndex, queryCount, buffer_dst, offset_dst, stride, flags);
+		}
+
+		// 取得查询结果, 若未指定VK_QUERY_RESULT_WAIT_BIT, 结果尚不可用时返回VK_NOT_READY
+		result_t GetResults(uint32_t firstQueryIndex, uint32_t queryCount, size_t dataSize, void* pData_dst, VkDeviceSize stride, VkQueryResultFlags flags = 0) const {
+			VkResult result = vkGetQueryPoolResults(graphicsBase::Base().Device(), handle, firstQueryIndex, queryCount, dataSize, pData_dst, stride, flags);
+			if (result < 0)
+				outStream << std::format("[ queryPool ] ERROR\nFailed to get query pool results!\nError code: {}\n", int32_t(result));
+			return result;
+		}
+
+		// 在CPU一侧重置查询, 需要Vulkan1.2的hostQueryReset特性
+		void Reset(uint32_t firstQueryIndex, uint32_t queryCount) const {
+			vkResetQueryPool(graphicsBase::Base().Device(), handle, firstQueryIndex, queryCount);
+		}
+
+		//Non-const Function
+		result_t Create(VkQueryPoolCreateInfo& createInfo) {
+			createInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			VkResult result = vkCreateQueryPool(graphicsBase::Base().Device(), &createInfo, nullptr, &handle);
+			if (result)
+				outStream << std::format("[ queryPool ] ERROR\nFailed to create a query pool!\nError code: {}\n", int32_t(result));
+			return result;
+		}
+
+		result_t Create(VkQueryType queryType, uint32_t queryCount, VkQueryPipelineStatisticFlags pipelineStatistics = 0 /*reserved for future use*/) {
+			VkQueryPoolCreateInfo createInfo = {
+				.queryType = queryType,
+				.queryCount = queryCount,
+				.pipelineStatistics = pipelineStatistics
+			};
+			return Create(createInfo);
+		}
+	};
+
+	// 设备内存
+	class deviceMemory {
+		VkDeviceMemory handle = VK_NULL_HANDLE;
+		VkDeviceSize allocationSize = 0;
+		VkMemoryPropertyFlags memoryProperties = 0;
+		uint32_t memoryTypeIndex = 0;
+		//--------------------
+		// 返回释放内存并更新graphicsBase中的统计的函数, 供延迟销毁
+		auto Destroyer_Internal() const {
+			return [device = graphicsBase::Base().Device(), handle = handle, memoryTypeIndex = memoryTypeIndex, allocationSize = allocationSize] {
+				vkFreeMemory(device, handle, nullptr);
+				graphicsBase::Base().CountDeviceMemory(memoryTypeIndex, -1, -int64_t(allocationSize));
+			};
+		}
+	public:
+		deviceMemory() = default;
+
+		deviceMemory(VkMemoryAllocateInfo& allocateInfo) {
+			Allocate(allocateInfo);
+		}
+
+		deviceMemory(deviceMemory&& other) noexcept {
+			MoveHandle;
+			allocationSize = other.allocationSize;
+			memoryProperties = other.memoryProperties;
+			memoryTypeIndex = other.memoryTypeIndex;
+			other.allocationSize = 0;
+			other.memoryProperties = 0;
+		}
+
+		~deviceMemory() {
+			if (handle)
+				graphicsBase::Base().CountDeviceMemory(memoryTypeIndex, -1, -int64_t(allocationSize));
+			DestroyHandleBy(vkFreeMemory);
+			allocationSize = 0;
+			memoryProperties = 0;
+		}
+
+		//Getter
+		DefineHandleTypeOperator;
+
+		DefineAddressFunction;
+
+		void DeferDestroy() {
+			if (handle)
+				graphicsBase::Base().DeferDestruction(Destroyer_Internal()),
+				handle = VK_NULL_HANDLE;
+		}
+
+		void DeferDestroy(VkSemaphore semaphore_timeline, uint64_t value) {
+			if (handle)
+				graphicsBase::Base().DeferDestruction(semaphore_timeline, value, Destroyer_Internal()),
+				handle = VK_NULL_HANDLE;
+		}
+
+		VkDeviceSize AllocationSize() const {
+			return allocationSize;
+		}
+
+		VkMemoryPropertyFlags MemoryProperties() const {
+			return memoryProperties;
+		}
+
+		//Const Function
+		result_t MapMemory(void*& pData, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0) const {
+			VkResult result = vkMapMemory(graphicsBase::Base().Device(), handle, offset, size, 0, &pData);
+			if (result)
+				outStream << std::format("[ deviceMemory ] ERROR\nFailed to map the memory!\nError code: {}\n", int32_t(result));
+			return result;
+		}
+
+		void UnmapMemory() const {
+			vkUnmapMemory(graphicsBase::Base().Device(), handle);
+		}
+
+		//Non-const Function
+		result_t Allocate(VkMemoryAllocateInfo& allocateInfo) {
+			if (allocateInfo.memoryTypeIndex >= graphicsBase::Base().PhysicalDeviceMemoryProperties().memoryTypeCount) {
+				outStream << std::format("[ deviceMemory ] ERROR\nInvalid memory type index!\n");
+				return VK_RESULT_MAX_ENUM;
+			}
+			allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			if (VkResult result = vkAllocateMemory(graphicsBase::Base().Device(), &allocateInfo, nullptr, &handle)) {
+				outStream << std::format("[ deviceMemory ] ERROR\nFailed to allocate memory!\nError code: {}\n", int32_t(result));
+				return result;
+			}
+			allocationSize = allocateInfo.allocationSize;
+			memoryProperties = graphicsBase::Base().PhysicalDeviceMemoryProperties().memoryTypes[allocateInfo.memoryTypeIndex].propertyFlags;
+			memoryTypeIndex = allocateInfo.memoryTypeIndex;
+			graphicsBase::Base().CountDeviceMemory(memoryTypeIndex, 1, allocationSize);
+			return VK_SUCCESS;
+		}
+	};
+
+	// 设备内存的子分配器, 按内存类型从较大的内存块中以伙伴（buddy）算法分配, 避免每个缓冲区或图像单独调用vkAllocateMemory而触及maxMemoryAllocationCount
+	// 伙伴算法分配的区间大小为2的幂, 其偏移量自然对齐到自身大小, 从而满足对齐要求
+	// bufferImageGranularity大于1时, 线性资源（缓冲区及线性图像）与optimal tiling的图像不共用内存块
+	class memoryAllocator {
+	public:
+		struct block;
+		struct allocation {
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+			VkDeviceSize offset = 0;
+			// 所请求的大小
+			VkDeviceSize size = 0;
+			uint32_t memoryTypeIndex = 0;
+			VkMemoryPropertyFlags memoryProperties = 0;
+			// 内存块可被主机访问时, 为该分配的映射地址（内存块在创建时即被持久映射）
+			void* pMappedData = nullptr;
+			block* pBlock = nullptr;
+			// 伙伴算法的阶数, 所占区间的大小为2^order, 独占内存块时为0
+			uint32_t order = 0;
+			//--------------------
+			explicit operator bool() const { return memory; }
+		};
+		// 各内存堆的统计信息
+		struct heapStatistics {
+			uint32_t blockCount;
+			uint32_t allocationCount;
+			// 所有内存块的大小之和
+			VkDeviceSize blockBytes;
+			// 所有分配所占区间的大小之和（伙伴算法取整后）
+			VkDeviceSize usedBytes;
+			// 所有分配所请求的大小之和
+			VkDeviceSize requestedBytes;
+		};
+		// 碎片整理时的重定位函数, 须将分配的所有者迁移到newAllocation（如录制复制命令并重新绑定）, 返回false时放弃该次移动
+		// 返回true时由其负责在复制完成后释放所有者先前持有的分配（如以graphicsBase::DeferDestruction(...)延迟释放）
+		using relocateFunction = std::function<bool(const allocation& oldAllocation, const allocation& newAllocation, void* pUserData)>;
+		struct block {
+			deviceMemory memory;
+			VkDeviceSize size;
+			uint32_t memoryTypeIndex;
+			uint32_t heapIndex;
+			// 是否用于存放optimal tiling的图像
+			bool optimal;
+			// 是否由单个分配独占
+			bool dedicated;
+			void* pMappedData;
+			VkDeviceSize usedBytes;
+			// 各阶空闲区间的偏移量, 下标为order - minOrder
+			std::vector<std::set<VkDeviceSize>> freeLists;
+			// 已分配区间的偏移量到其阶数及所有者的映射
+			struct record {
+				uint32_t order;
+				VkDeviceSize size;
+				void* pUserData;
+			};
+			std::map<VkDeviceSize, record> allocations;
+		};
+		// 伙伴算法的最小分配单位为2^minOrder字节
+		static constexpr uint32_t minOrder = 8;
+		// 内存块的默认大小为2^defaultBlockOrder字节, 内存堆较小时相应减小
+		static constexpr uint32_t defaultBlockOrder = 26;
+	private:
+		std::vector<std::unique_ptr<block>> blocks;
+		heapStatistics statistics[VK_MAX_MEMORY_HEAPS] = {};
+		std::mutex mutex;
+		//--------------------
+		memoryAllocator() = default;
+		memoryAllocator(memoryAllocator&&) = delete;
+		// 不析构, 以免先于graphicsBase的单例被析构, 其内存块在销毁逻辑设备时被释放
+		~memoryAllocator() = default;
+		uint32_t BlockOrder(uint32_t heapIndex) const {
+			VkDeviceSize heapSize = graphicsBase::Base().PhysicalDeviceMemoryProperties().memoryHeaps[heapIndex].size;
+			return std::clamp(uint32_t(std::bit_width(heapSize / 8)) - 1, 20u, defaultBlockOrder);
+		}
+		bool IsLinearOnly_Internal(bool optimal) const {
+			return !optimal || graphicsBase::Base().PhysicalDeviceProperties().limits.bufferImageGranularity <= 1;
+		}
+		static bool AllocateFromBlock_Internal(block& block, uint32_t order, VkDeviceSize& offset) {
+			uint32_t blockOrder = uint32_t(std::bit_width(block.size)) - 1;
+			uint32_t k = order;
+			while (k <= blockOrder && block.freeLists[k - minOrder].empty())
+				k++;
+			if (k > blockOrder)
+				return false;
+			auto& freeList = block.freeLists[k - minOrder];
+			offset = *freeList.begin();
+			freeList.erase(freeList.begin());
+			// 将多出的部分逐级对半拆分, 后一半放入空闲列表
+			while (k > order)
+				k--,
+				block.freeLists[k - minOrder].insert(offset + (VkDeviceSize(1) << k));
+			return true;
+		}
+		static void FreeToBlock_Internal(block& block, VkDeviceSize offset, uint32_t order) {
+			uint32_t blockOrder = uint32_t(std::bit_width(block.size)) - 1;
+			// 伙伴空闲时与之合并
+			for (; order < blockOrder; order++) {
+				auto& freeList = block.freeLists[order - minOrder];
+				auto iterator = freeList.find(offset ^ VkDeviceSize(1) << order);
+				if (iterator == freeList.end())
+					break;
+				freeList.erase(iterator);
+				offset &= ~(VkDeviceSize(1) << order);
+			}
+			block.freeLists[order - minOrder].insert(offset);
+		}
+		result_t CreateBlock_Internal(uint32_t memoryTypeIndex, VkDeviceSize size, bool optimal, bool dedicated, block*& pBlock) {
+			auto& memoryProperties = graphicsBase::Base().PhysicalDeviceMemoryProperties();
+			uint32_t heapIndex = memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+			if (uint32_t count = std::accumulate(std::begin(statistics), std::end(statistics), 0u, [](uint32_t sum, const heapStatistics& i) { return sum + i.blockCount; });
+				count >= graphicsBase::Base().PhysicalDeviceProperties().limits.maxMemoryAllocationCount) {
+				outStream << std::format("[ memoryAllocator ] ERROR\nReached maxMemoryAllocationCount: {}!\n", count);
+				return VK_ERROR_TOO_MANY_OBJECTS;
+			}
+			auto newBlock = std::make_unique<block>();
+			VkMemoryAllocateInfo allocateInfo = {
+				.allocationSize = size,
+				.memoryTypeIndex = memoryTypeIndex
+			};
+			if (VkResult result = newBlock->memory.Allocate(allocateInfo))
+				return result;
+			newBlock->size = size;
+			newBlock->memoryTypeIndex = memoryTypeIndex;
+			newBlock->heapIndex = heapIndex;
+			newBlock->optimal = optimal;
+			newBlock->dedicated = dedicated;
+			newBlock->pMappedData = nullptr;
+			newBlock->usedBytes = 0;
+			if (newBlock->memory.MemoryProperties() & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+				if (VkResult result = newBlock->memory.MapMemory(newBlock->pMappedData))
+					return result;
+			if (!dedicated) {
+				uint32_t blockOrder = uint32_t(std::bit_width(size)) - 1;
+				newBlock->freeLists.resize(blockOrder - minOrder + 1);
+				newBlock->freeLists.back().insert(0);
+			}
+			statistics[heapIndex].blockCount++;
+			statistics[heapIndex].blockBytes += size;
+			pBlock = blocks.emplace_back(std::move(newBlock)).get();
+			return VK_SUCCESS;
+		}
+		void DestroyBlock_Internal(block* pBlock) {
+			auto& heap = statistics[pBlock->heapIndex];
+			heap.blockCount--;
+			heap.blockBytes -= pBlock->size;
+			std::erase_if(blocks, [pBlock](const std::unique_ptr<block>& i) { return i.get() == pBlock; });
+		}
+		// 在已有的（非独占的）内存块中分配, 不创建新的内存块
+		bool AllocateFromExistingBlocks_Internal(uint32_t memoryTypeIndex, bool optimal, uint32_t order, const block* pExcludedBlock, allocation& allocation) {
+			bool linearOnly = IsLinearOnly_Internal(optimal);
+			for (auto& i : blocks)
+				if (!i->dedicated &&
+					i.get() != pExcludedBlock &&
+					i->memoryTypeIndex == memoryTypeIndex &&
+					IsLinearOnly_Internal(i->optimal) == linearOnly &&
+					AllocateFromBlock_Internal(*i, order, allocation.offset)) {
+					allocation.pBlock = i.get();
+					return true;
+				}
+			return false;
+		}
+		void Record_Internal(allocation& allocation, uint32_t order, VkDeviceSize size, void* pUserData) {
+			block& memoryBlock = *allocation.pBlock;
+			VkDeviceSize usedBytes = order ? VkDeviceSize(1) << order : memoryBlock.size;
+			allocation.memory = memoryBlock.memory;
+			allocation.size = size;
+			allocation.memoryTypeIndex = memoryBlock.memoryTypeIndex;
+			allocation.memoryProperties = memoryBlock.memory.MemoryProperties();
+			allocation.pMappedData = memoryBlock.pMappedData ? static_cast<uint8_t*>(memoryBlock.pMappedData) + allocation.offset : nullptr;
+			allocation.order = order;
+			memoryBlock.allocations[allocation.offset] = { order, size, pUserData };
+			memoryBlock.usedBytes += usedBytes;
+			auto& heap = statistics[memoryBlock.heapIndex];
+			heap.allocationCount++;
+			heap.usedBytes += usedBytes;
+			heap.requestedBytes += size;
+		}
+		bool HasBlock_Internal(const block* pBlock) const {
+			return std::find_if(blocks.begin(), blocks.end(), [&](const std::unique_ptr<block>& i) { return i.get() == pBlock; }) != blocks.end();
+		}
+		void Free_Internal(const allocation& allocation) {
+			// 内存块可能已在销毁逻辑设备时被释放
+			if (!HasBlock_Internal(allocation.pBlock))
+				return;
+			block& memoryBlock = *allocation.pBlock;
+			auto iterator = memoryBlock.allocations.find(allocation.offset);
+			if (iterator == memoryBlock.allocations.end())
+				return;
+			VkDeviceSize usedBytes = allocation.order ? VkDeviceSize(1) << allocation.order : memoryBlock.size;
+			auto& heap = statistics[memoryBlock.heapIndex];
+			heap.allocationCount--;
+			heap.usedBytes -= usedBytes;
+			heap.requestedBytes -= iterator->second.size;
+			memoryBlock.usedBytes -= usedBytes;
+			memoryBlock.allocations.erase(iterator);
+			if (memoryBlock.dedicated) {
+				DestroyBlock_Internal(&memoryBlock);
+				return;
+			}
+			FreeToBlock_Internal(memoryBlock, allocation.offset, allocation.order);
+			// 同类的空闲内存块只保留一个, 以免反复分配和释放内存块
+			if (!memoryBlock.usedBytes)
+				for (auto& i : blocks)
+					if (i.get() != &memoryBlock &&
+						!i->dedicated &&
+						!i->usedBytes &&
+						i->memoryTypeIndex == memoryBlock.memoryTypeIndex &&
+						i->optimal == memoryBlock.optimal) {
+						DestroyBlock_Internal(&memoryBlock);
+						return;
+					}
+		}
+		void ReleaseAll_Internal() {
+			std::lock_guard lock(mutex);
+			for (auto& i : blocks)
+				if (i->allocations.size())
+					outStream << std::format("[ memoryAllocator ] WARNING\n{} allocation(s) are still alive when the device is destroyed!\n", i->allocations.size());
+			blocks.clear();
+			std::fill(std::begin(statistics), std::end(statistics), heapStatistics{});
+		}
+	public:
+		//Getter
+		const heapStatistics& Statistics(uint32_t heapIndex) const {
+			return statistics[heapIndex];
+		}
+		//Const Function
+		// 各内存堆的统计信息, 以表格形式输出
+		std::string Report() const {
+			auto& memoryProperties = graphicsBase::Base().PhysicalDeviceMemoryProperties();
+			std::string report = std::format("{:<8}{:>8}{:>12}{:>14}{:>14}{:>14}\n", "Heap", "blocks", "allocations", "block (MiB)", "used (MiB)", "request (MiB)");
+			for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++)
+				report += std::format("{:<8}{:>8}{:>12}{:>14.2f}{:>14.2f}{:>14.2f}\n", i, statistics[i].blockCount, statistics[i].allocationCount,
+					statistics[i].blockBytes / 1048576.0, statistics[i].usedBytes / 1048576.0, statistics[i].requestedBytes / 1048576.0);
+			return report;
+		}
+		// 内存堆中非独占内存块的碎片化程度, 为1 - 最大空闲区间 / 空闲总量, 0表示空闲区间完全连续
+		double Fragmentation(uint32_t heapIndex) {
+			std::lock_guard lock(mutex);
+			VkDeviceSize freeBytes = 0;
+			VkDeviceSize largestFreeBytes = 0;
+			for (auto& i : blocks)
+				if (i->heapIndex == heapIndex &&
+					!i->dedicated) {
+					freeBytes += i->size - i->usedBytes;
+					for (size_t j = i->freeLists.size(); j--;)
+						if (i->freeLists[j].size()) {
+							largestFreeBytes = std::max(largestFreeBytes, VkDeviceSize(1) << (j + minOrder));
+							break;
+						}
+				}
+			return freeBytes ? 1 - double(largestFreeBytes) / double(freeBytes) : 0;
+		}
+		result_t Flush(const allocation& allocation, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE) const {
+			if (allocation.memoryProperties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+				return VK_SUCCESS;
+			VkMappedMemoryRange mappedMemoryRange = MappedMemoryRange(allocation, offset, size);
+			VkResult result = vkFlushMappedMemoryRanges(graphicsBase::Base().Device(), 1, &mappedMemoryRange);
+			if (result)
+				outStream << std::format("[ memoryAllocator ] ERROR\nFailed to flush the memory!\nError code: {}\n", int32_t(result));
+			return result;
+		}
+		result_t Invalidate(const allocation& allocation, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE) const {
+			if (allocation.memoryProperties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+				return VK_SUCCESS;
+			VkMappedMemoryRange mappedMemoryRange = MappedMemoryRange(allocation, offset, size);
+			VkResult result = vkInvalidateMappedMemoryRanges(graphicsBase::Base().Device(), 1, &mappedMemoryRange);
+			if (result)
+				outStream << std::format("[ memoryAllocator ] ERROR\nFailed to invalidate the memory!\nError code: {}\n", int32_t(result));
+			return result;
+		}
+		//Non-const Function
+		// optimal为true表示用于optimal tiling的图像, pUserData非空的分配可在碎片整理时被移动
+		result_t Allocate(const VkMemoryRequirements& memoryRequirements, VkMemoryPropertyFlags desiredMemoryProperties, bool optimal, allocation& allocation, void* pUserData = nullptr) {
+			uint32_t memoryTypeIndex = MemoryTypeIndex(memoryRequirements.memoryTypeBits, desiredMemoryProperties);
+			if (memoryTypeIndex == UINT32_MAX) {
+				outStream << std::format("[ memoryAllocator ] ERROR\nFailed to find any memory type satisfies all desired memory properties!\n");
+				return VK_RESULT_MAX_ENUM;
+			}
+			uint32_t heapIndex = graphicsBase::Base().PhysicalDeviceMemoryProperties().memoryTypes[memoryTypeIndex].heapIndex;
+			uint32_t blockOrder = BlockOrder(heapIndex);
+			uint32_t order = std::max(minOrder, uint32_t(std::bit_width(std::max(memoryRequirements.size, memoryRequirements.alignment) - 1)));
+			std::lock_guard lock(mutex);
+			allocation = {};
+			// 大于内存块一半的资源独占内存块
+			if (order >= blockOrder) {
+				if (VkResult result = CreateBlock_Internal(memoryTypeIndex, memoryRequirements.size, optimal, true, allocation.pBlock))
+					return result;
+				Record_Internal(allocation, 0, memoryRequirements.size, pUserData);
+				return VK_SUCCESS;
+			}
+			if (!AllocateFromExistingBlocks_Internal(memoryTypeIndex, optimal, order, nullptr, allocation)) {
+				if (VkResult result = CreateBlock_Internal(memoryTypeIndex, VkDeviceSize(1) << blockOrder, optimal, false, allocation.pBlock))
+					return result;
+				AllocateFromBlock_Internal(*allocation.pBlock, order, allocation.offset);
+			}
+			Record_Internal(allocation, order, memoryRequirements.size, pUserData);
+			return VK_SUCCESS;
+		}
+		void Free(allocation& allocation) {
+			if (!allocation)
+				return;
+			std::lock_guard lock(mutex);
+			Free_Internal(allocation);
+			allocation = {};
+		}
+		// 更改分配的所有者, 所有者被移动时调用
+		void UserData(const allocation& allocation, void* pUserData) {
+			if (!allocation)
+				return;
+			std::lock_guard lock(mutex);
+			if (auto iterator = allocation.pBlock->allocations.find(allocation.offset); iterator != allocation.pBlock->allocations.end())
+				iterator->second.pUserData = pUserData;
+		}
+		// 释放所有空闲的内存块
+		void FreeEmptyBlocks() {
+			std::lock_guard lock(mutex);
+			std::vector<block*> emptyBlocks;
+			for (auto& i : blocks)
+				if (!i->usedBytes)
+					emptyBlocks.push_back(i.get());
+			for (auto i : emptyBlocks)
+				DestroyBlock_Internal(i);
+		}
+		// 碎片整理: 将占用率最低的内存块中可移动的分配逐一移到同类的其他内存块, 不创建新的内存块, 返回移动的次数
+		// 旧区间由relocate延迟到当前帧执行完毕后释放, 因此relocate中录制的复制命令须在当前帧中提交
+		// 移动期间源记录的pUserData被清空, 旧区间被释放前再次整理时不会重复移动同一分配
+		uint32_t Defragment(const relocateFunction& relocate, uint32_t maxMoveCount = UINT32_MAX) {
+			block* pSource = nullptr;
+			std::vector<std::pair<VkDeviceSize, block::record>> movables;
+			{
+				std::lock_guard lock(mutex);
+				for (auto& i : blocks)
+					if (!i->dedicated &&
+						i->usedBytes &&
+						(!pSource || i->usedBytes * pSource->size < pSource->usedBytes * i->size))
+						pSource = i.get();
+				if (!pSource)
+					return 0;
+				for (auto& [offset, record] : pSource->allocations)
+					if (record.pUserData)
+						movables.push_back({ offset, record });
+			}
+			uint32_t moveCount = 0;
+			for (auto& [offset, record] : movables) {
+				if (moveCount >= maxMoveCount)
+					break;
+				allocation oldAllocation;
+				allocation newAllocation;
+				{
+					std::lock_guard lock(mutex);
+					// 收集后源内存块可能已被销毁, 该分配可能已被释放或已在移动中
+					if (!HasBlock_Internal(pSource))
+						break;
+					auto iterator = pSource->allocations.find(offset);
+					if (iterator == pSource->allocations.end() ||
+						iterator->second.pUserData != record.pUserData)
+						continue;
+					if (!AllocateFromExistingBlocks_Internal(pSource->memoryTypeIndex, pSource->optimal, record.order, pSource, newAllocation))
+						break;
+					Record_Internal(newAllocation, record.order, record.size, record.pUserData);
+					iterator->second.pUserData = nullptr;
+					// 在持有锁时复制源内存块的信息, 源记录在旧区间被释放前保留, 内存块不会因变空而被销毁
+					oldAllocation = {
+						.memory = pSource->memory,
+						.offset = offset,
+						.size = record.size,
+						.memoryTypeIndex = pSource->memoryTypeIndex,
+						.memoryProperties = pSource->memory.MemoryProperties(),
+						.pMappedData = pSource->pMappedData ? static_cast<uint8_t*>(pSource->pMappedData) + offset : nullptr,
+						.pBlock = pSource,
+						.order = record.order
+					};
+				}
+				// 调用relocate时不持有锁, 以便在其中创建或销毁其他资源
+				if (!relocate(oldAllocation, newAllocation, record.pUserData)) {
+					std::lock_guard lock(mutex);
+					if (auto iterator = pSource->allocations.find(offset); iterator != pSource->allocations.end())
+						iterator->second.pUserData = record.pUserData;
+					Free_Internal(newAllocation);
+					continue;
+				}
+				moveCount++;
+			}
+			return moveCount;
+		}
+		//Static Function
+		static memoryAllocator& Default() {
+			// 以new创建且不析构, 在销毁逻辑设备时释放所有内存块
+			static memoryAllocator& allocator = []() -> memoryAllocator& {
+				graphicsBase::Base().PushCallback_DestroyDevice([] { Default().ReleaseAll_Internal(); });
+				return *new memoryAllocator;
+			}();
+			return allocator;
+		}
+		// 返回满足所有desiredMemoryProperties的第一个内存类型, 找不到时放宽HOST_CACHED和LAZILY_ALLOCATED的要求, 仍找不到则返回UINT32_MAX
+		static uint32_t MemoryTypeIndex(uint32_t memoryTypeBits, VkMemoryPropertyFlags desiredMemoryProperties) {
+			auto& memoryProperties = graphicsBase::Base().PhysicalDeviceMemoryProperties();
+			for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+				if (memoryTypeBits & 1 << i &&
+					(memoryProperties.memoryTypes[i].propertyFlags & desiredMemoryProperties) == desiredMemoryProperties)
+					return i;
+			constexpr VkMemoryPropertyFlags optionalProperties = VK_MEMORY_PROPERTY_HOST_CACHED_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+			if (desiredMemoryProperties & optionalProperties)
+				return MemoryTypeIndex(memoryTypeBits, desiredMemoryProperties & ~optionalProperties);
+			return UINT32_MAX;
+		}
+		// 将相对于分配的范围转为对齐到nonCoherentAtomSize的VkMappedMemoryRange
+		static VkMappedMemoryRange MappedMemoryRange(const allocation& allocation, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE) {
+			VkDeviceSize atomSize = graphicsBase::Base().PhysicalDeviceProperties().limits.nonCoherentAtomSize;
+			if (size == VK_WHOLE_SIZE)
+				size = allocation.size - offset;
+			VkDeviceSize begin = (allocation.offset + offset) / atomSize * atomSize;
+			VkDeviceSize end = (allocation.offset + offset + size + atomSize - 1) / atomSize * atomSize;
+			VkDeviceSize memorySize = allocation.pBlock->size;
+			return {
+				.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+				.memory = allocation.memory,
+				.offset = begin,
+				.size = end < memorySize ? end - begin : VK_WHOLE_SIZE
+			};
+		}
+	};
+
+	// 从memoryAllocator::Default()中子分配内存的缓冲区
+	class buffer {
+		VkBuffer handle = VK_NULL_HANDLE;
+		memoryAllocator::allocation allocation;
+		// 保存创建信息以便在碎片整理时重建缓冲区, 不含pNext及队列族索引
+		VkBufferCreateInfo createInfo = {};
+		// 是否可在碎片整理时被移动
+		bool relocatable = false;
+	public:
+		buffer() = default;
+
+		buffer(VkBufferCreateInfo& createInfo, VkMemoryPropertyFlags desiredMemoryProperties, bool relocatable = false) {
+			Create(createInfo, desiredMemoryProperties, relocatable);
+		}
+
+		buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags desiredMemoryProperties, bool relocatable = false) {
+			Create(size, usage, desiredMemoryProperties, relocatable);
+		}
+
+		buffer(buffer&& other) noexcept {
+			MoveHandle;
+			allocation = other.allocation;
+			createInfo = other.createInfo;
+			relocatable = other.relocatable;
+			other.allocation = {};
+			if (relocatable)
+				memoryAllocator::Default().UserData(allocation, this);
+		}
+
+		~buffer() {
+			if (handle)
+				graphicsBase::Base().CountResource(resourceType_buffer, -1, -int64_t(allocation.size));
+			DestroyHandleBy(vkDestroyBuffer);
+			memoryAllocator::Default().Free(allocation);
+		}
+
+		//Getter
+		DefineHandleTypeOperator;
+
+		DefineAddressFunction;
+
+		const memoryAllocator::allocation& Allocation() const {
+			return allocation;
+		}
+
+		// 内存可被主机访问时为映射地址, 否则为nullptr
+		void* MappedData() const {
+			return allocation.pMappedData;
+		}
+
+		VkDeviceSize Size() const {
+			return createInfo.size;
+		}
+
+		bool Relocatable() const {
+			return relocatable;
+		}
+
+		//Const Function
+		result_t Flush(VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE) const {
+			return memoryAllocator::Default().Flush(allocation, offset, size);
+		}
+
+		result_t Invalidate(VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE) const {
+			return memoryAllocator::Default().Invalidate(allocation, offset, size);
+		}
+
+		//Non-const Function
+		// 在当前帧执行完毕后销毁缓冲区并释放内存
+		void DeferDestroy() {
+			if (handle || allocation)
+				graphicsBase::Base().DeferDestruction([device = graphicsBase::Base().Device(), handle = handle, allocation = allocation]() mutable {
+					if (handle)
+						vkDestroyBuffer(device, handle, nullptr),
+						graphicsBase::Base().CountResource(resourceType_buffer, -1, -int64_t(allocation.size));
+					memoryAllocator::Default().Free(allocation);
+				});
+			handle = VK_NULL_HANDLE;
+			allocation = {};
+		}
+
+		// relocatable为true时可在碎片整理时被移动, 但被映射的缓冲区不参与（其映射地址可能已被缓存）
+		result_t Create(VkBufferCreateInfo& createInfo, VkMemoryPropertyFlags desiredMemoryProperties, bool relocatable = false) {
+			createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			if (VkResult result = vkCreateBuffer(graphicsBase::Base().Device(), &createInfo, nullptr, &handle)) {
+				outStream << std::format("[ buffer ] ERROR\nFailed to create a buffer!\nError code: {}\n", int32_t(result));
+				return result;
+			}
+			this->createInfo = createInfo;
+			this->createInfo.pNext = nullptr;
+			this->createInfo.queueFamilyIndexCount = 0;
+			this->createInfo.pQueueFamilyIndices = nullptr;
+			VkMemoryRequirements memoryRequirements;
+			vkGetBufferMemoryRequirements(graphicsBase::Base().Device(), handle, &memoryRequirements);
+			// 失败时销毁缓冲区, 使有效的handle总是对应已绑定的内存, 以保持graphicsBase中的统计一致
+			VkResult result = memoryAllocator::Default().Allocate(memoryRequirements, desiredMemoryProperties, false, allocation);
+			if (!result) {
+				result = vkBindBufferMemory(graphicsBase::Base().Device(), handle, allocation.memory, allocation.offset);
+				if (result)
+					outStream << std::format("[ buffer ] ERROR\nFailed to bind the memory to the buffer!\nError code: {}\n", int32_t(result));
+			}
+			if (result) {
+				vkDestroyBuffer(graphicsBase::Base().Device(), handle, nullptr);
+				handle = VK_NULL_HANDLE;
+				memoryAllocator::Default().Free(allocation);
+				return result;
+			}
+			this->relocatable = relocatable && !allocation.pMappedData;
+			if (this->relocatable)
+				memoryAllocator::Default().UserData(allocation, this);
+			graphicsBase::Base().CountResource(resourceType_buffer, 1, allocation.size);
+			return VK_SUCCESS;
+		}
+
+		result_t Create(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags desiredMemoryProperties, bool relocatable = false) {
+			VkBufferCreateInfo createInfo = {
+				.size = size,
+				.usage = usage
+			};
+			return Create(createInfo, desiredMemoryProperties, relocatable);
+		}
+
+		// 供memoryAllocator::Defragment(...)的relocate调用（仅以relocatable创建的缓冲区会被移动）: 在newAllocation上重建缓冲区并录制从旧缓冲区复制数据的命令, 旧缓冲区被延迟销毁
+		// 缓冲区须具有VK_BUFFER_USAGE_TRANSFER_SRC_BIT和VK_BUFFER_USAGE_TRANSFER_DST_BIT, 被替换的内存区间在复制完成后被释放
+		result_t Relocate(const memoryAllocator::allocation& newAllocation, VkCommandBuffer commandBuffer) {
+			VkBuffer newHandle = VK_NULL_HANDLE;
+			if (VkResult result = vkCreateBuffer(graphicsBase::Base().Device(), &createInfo, nullptr, &newHandle)) {
+				outStream << std::format("[ buffer ] ERROR\nFailed to create a buffer!\nError code: {}\n", int32_t(result));
+				return result;
+			}
+			if (VkResult result = vkBindBufferMemory(graphicsBase::Base().Device(), newHandle, newAllocation.memory, newAllocation.offset)) {
+				outStream << std::format("[ buffer ] ERROR\nFailed to bind the memory to the buffer!\nError code: {}\n", int32_t(result));
+				vkDestroyBuffer(graphicsBase::Base().Device(), newHandle, nullptr);
+				return result;
+			}
+			VkBufferCopy region = { 0, 0, createInfo.size };
+			vkCmdCopyBuffer(commandBuffer, handle, newHandle, 1, &region);
+			graphicsBase::Base().DeferDestruction([device = graphicsBase::Base().Device(), handle = handle] { vkDestroyBuffer(device, handle, nullptr); });
+			graphicsBase::Base().DeferDestruction([oldAllocation = allocation]() mutable { memoryAllocator::Default().Free(oldAllocation); });
+			handle = newHandle;
+			allocation = newAllocation;
+			return VK_SUCCESS;
+		}
+	};
+
+	// 从memoryAllocator::Default()中子分配内存的图像, 图像的分配不参与碎片整理
+	class image {
+		VkImage handle = VK_NULL_HANDLE;
+		memoryAllocator::allocation allocation;
+	public:
+		image() = default;
+
+		image(VkImageCreateInfo& createInfo, VkMemoryPropertyFlags desiredMemoryProperties) {
+			Create(createInfo, desiredMemoryProperties);
+		}
+
+		image(image&& other) noexcept {
+			MoveHandle;
+			allocation = other.allocation;
+			other.allocation = {};
+		}
+
+		~image() {
+			if (handle)
+				graphicsBase::Base().CountResource(resourceType_image, -1, -int64_t(allocation.size));
+			DestroyHandleBy(vkDestroyImage);
+			memoryAllocator::Default().Free(allocation);
+		}
+
+		//Getter
+		DefineHandleTypeOperator;
+
+		DefineAddressFunction;
+
+		const memoryAllocator::allocation& Allocation() const {
+			return allocation;
+		}
+
+		//Non-const Function
+		// 在当前帧执行完毕后销毁图像并释放内存
+		void DeferDestroy() {
+			if (handle || allocation)
+				graphicsBase::Base().DeferDestruction([device = graphicsBase::Base().Device(), handle = handle, allocation = allocation]() mutable {
+					if (handle)
+						vkDestroyImage(device, handle, nullptr),
+						graphicsBase::Base().CountResource(resourceType_image, -1, -int64_t(allocation.size));
+					memoryAllocator::Default().Free(allocation);
+				});
+			handle = VK_NULL_HANDLE;
+			allocation = {};
+		}
+
+		result_t Create(VkImageCreateInfo& createInfo, VkMemoryPropertyFlags desiredMemoryProperties) {
+			createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			if (VkResult result = vkCreateImage(graphicsBase::Base().Device(), &createInfo, nullptr, &handle)) {
+				outStream << std::format("[ image ] ERROR\nFailed to create an image!\nError code: {}\n", int32_t(result));
+				return result;
+			}
+			VkMemoryRequirements memoryRequirements;
+			vkGetImageMemoryRequirements(graphicsBase::Base().Device(), handle, &memoryRequirements);
+			// 失败时销毁图像, 使有效的handle总是对应已绑定的内存, 以保持graphicsBase中的统计一致
+			VkResult result = memoryAllocator::Default().Allocate(memoryRequirements, desiredMemoryProperties, createInfo.tiling == VK_IMAGE_TILING_OPTIMAL, allocation);
+			if (!result) {
+				result = vkBindImageMemory(graphicsBase::Base().Device(), handle, allocation.memory, allocation.offset);
+				if (result)
+					outStream << std::format("[ image ] ERROR\nFailed to bind the memory to the image!\nError code: {}\n", int32_t(result));
+			}
+			if (result) {
+				vkDestroyImage(graphicsBase::Base().Device(), handle, nullptr);
+				handle = VK_NULL_HANDLE;
+				memoryAllocator::Default().Free(allocation);
+				return result;
+			}
+			graphicsBase::Base().CountResource(resourceType_image, 1, allocation.size);
+			return VK_SUCCESS;
+		}
+	};
+
+	class imageView {
+		VkImageView handle = VK_NULL_HANDLE;
+	public:
+		imageView() = default;
+
+		imageView(VkImageViewCreateInfo& createInfo) {
+			Create(createInfo);
+		}
+
+		imageView(VkImage image, VkImageViewType viewType, VkFormat format, const VkImageSubresourceRange& subresourceRange) {
+			Create(image, viewType, format, subresourceRange);
+		}
+
+		imageView(imageView&& other) noexcept { MoveHandle; }
+
+		~imageView() { DestroyHandleBy(vkDestroyImageView); }
+
+		//Getter
+		DefineHandleTypeOperator;
+
+		DefineAddressFunction;
+
+		DefineDeferredDestroyFunction(vkDestroyImageView);
+
+		//Non-const Function
+		result_t Create(VkImageViewCreateInfo& createInfo) {
+			createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			VkResult result = vkCreateImageView(graphicsBase::Base().Device(), &createInfo, nullptr, &handle);
+			if (result)
+				outStream << std::format("[ imageView ] ERROR\nFailed to create an image view!\nError code: {}\n", int32_t(result));
+			return result;
+		}
+
+		result_t Create(VkImage image, VkImageViewType viewType, VkFormat format, const VkImageSubresourceRange& subresourceRange) {
+			VkImageViewCreateInfo createInfo = {
+				.image = image,
+				.viewType = viewType,
+				.format = format,
+				.subresourceRange = subresourceRange
+			};
+			return Create(createInfo);
+		}
+	};
+
+	// 描述符集布局
+	class descriptorSetLayout {
+		VkDescriptorSetLayout handle = VK_NULL_HANDLE;
+	public:
+		descriptorSetLayout() = default;
+
+		descriptorSetLayout(VkDescriptorSetLayoutCreateInfo& createInfo) {
+			Create(createInfo);
+		}
+
+		descriptorSetLayout(descriptorSetLayout&& other) noexcept { MoveHandle; }
+
+		~descriptorSetLayout() { DestroyHandleBy(vkDestroyDescriptorSetLayout); }
+
+		//Getter
+		DefineHandleTypeOperator;
+
+		DefineAddressFunction;
+
+		DefineDeferredDestroyFunction(vkDestroyDescriptorSetLayout);
+
+		//Non-const Function
+		result_t Create(VkDescriptorSetLayoutCreateInfo& createInfo) {
+			createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+			VkResult result = vkCreateDescriptorSetLayout(graphicsBase::Base().Device(), &createInfo, nullptr, &handle);
+			if (result)
+				outStream << std::format("[ descriptorSetLayout ] ERROR\nFailed to create a descriptor set layout!\nError code: {}\n", int32_t(result));
+			return result;
+		}
+	};
+
+	// 描述符集, 由descriptorPool分配, 随描述符池一并销毁
+	class descriptorSet {
+		friend class descriptorPool;
+		VkDescriptorSet handle = VK_NULL_HANDLE;
+	public:
+		descriptorSet() = default;
+
+		descriptorSet(descriptorSet&& other) noexcept { MoveHandle; }
+
+		//Getter
+		DefineHandleTypeOperator;
+
+		DefineAddressFunction;
+
+		//Const Function
+		// 写入描述符前须确保该描述符集不在执行中
+		void Write(arrayRef<const VkDescriptorImageInfo> descriptorInfos, VkDescriptorType descriptorType, uint32_t dstBinding = 0, uint32_t dstArrayElement = 0) const {
+			VkWriteDescriptorSet writeDescriptorSet = {
+				.dstSet = handle,
+				.dstBinding = dstBinding,
+				.dstArrayElement = dstArrayElement,
+				.descriptorCount = uint32_t(descriptorInfos.Count()),
+				.descriptorType = descriptorType,
+				.pImageInfo = descriptorInfos.Pointer()
+			};
+			Update(writeDescriptorSet);
+		}
+
+		void Write(arrayRef<const VkDescriptorBufferInfo> descriptorInfos, VkDescriptorType descriptorType, uint32_t dstBinding = 0, uint32_t dstArrayElement = 0) const {
+			VkWriteDescriptorSet writeDescriptorSet = {
+				.dstSet = handle,
+				.dstBinding = dstBinding,
+				.dstArrayElement = dstArrayElement,
+				.descriptorCount = uint32_t(descriptorInfos.Count()),
+				.descriptorType = descriptorType,
+				.pBufferInfo = descriptorInfos.Pointer()
+			};
+			Update(writeDescriptorSet);
+		}
+
+		//Static Function
+		static void Update(arrayRef<VkWriteDescriptorSet> writes, arrayRef<VkCopyDescriptorSet> copies = {}) {
+			for (auto& i : writes)
+				i.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			for (auto& i : copies)
+				i.sType = VK_STRUCTURE_TYPE_COPY_DESCRIPTOR_SET;
+			vkUpdateDescriptorSets(graphicsBase::Base().Device(), uint32_t(writes.Count()), writes.Pointer(), uint32_t(copies.Count()), copies.Pointer());
+		}
+	};
+
+	// 描述符池
+	class descriptorPool {
+		VkDescriptorPool handle = VK_NULL_HANDLE;
+	public:
+		descriptorPool() = default;
+
+		descriptorPool(VkDescriptorPoolCreateInfo& createInfo) {
+			Create(createInfo);
+		}
+
+		descriptorPool(uint32_t maxSetCount, arrayRef<const VkDescriptorPoolSize> poolSizes, VkDescriptorPoolCreateFlags flags = 0) {
+			Create(maxSetCount, poolSizes, flags);
+		}
+
+		descriptorPool(descriptorPool&& other) noexcept { MoveHandle; }
+
+		~descriptorPool() { DestroyHandleBy(vkDestroyDescriptorPool); }
+
+		//Getter
+		DefineHandleTypeOperator;
+
+		DefineAddressFunction;
+
+		DefineDeferredDestroyFunction(vkDestroyDescriptorPool);
+
+		//Const Function
+		result_t AllocateSets(arrayRef<VkDescriptorSet> sets, arrayRef<const VkDescriptorSetLayout> setLayouts) const {
+			if (sets.Count() != setLayouts.Count()) {
+				outStream << std::format("[ descriptorPool ] ERROR\nFor each descriptor set, must provide a corresponding layout!\n");
+				return VK_RESULT_MAX_ENUM;
+			}
+			VkDescriptorSetAllocateInfo allocateInfo = {
+				.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+				.descriptorPool = handle,
+				.descriptorSetCount = uint32_t(sets.Count()),
+				.pSetLayouts = setLayouts.Pointer()
+			};
+			VkResult result = vkAllocateDescriptorSets(graphicsBase::Base().Device(), &allocateInfo, sets.Pointer());
+			if (result)
+				outStream << std::format("[ descriptorPool ] ERROR\nFailed to allocate descriptor sets!\nError code: {}\n", int32_t(result));
+			return result;
+		}
+
+		result_t AllocateSets(arrayRef<descriptorSet> sets, arrayRef<const descriptorSetLayout> setLayouts) const {
+			return AllocateSets(
+				{ &sets[0].handle, sets.Count() },
+				{ setLayouts[0].Address(), setLayouts.Count() });
+		}
+
+		// 仅当创建时指定了VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT时可用
+		result_t FreeSets(arrayRef<VkDescriptorSet> sets) const {
+			VkResult result = vkFreeDescriptorSets(graphicsBase::Base().Device(), handle, uint32_t(sets.Count()), sets.Pointer());
+			if (result)
+				outStream << std::format("[ descriptorPool ] ERROR\nFailed to free descriptor sets!\nError code: {}\n", int32_t(result));
+			memset(sets.Pointer(), 0, sets.Count() * sizeof(VkDescriptorSet));
+			return result;
+		}
+
+		result_t FreeSets(arrayRef<descriptorSet> sets) const {
+			return FreeSets({ &sets[0].handle, sets.Count() });
+		}
+
+		// 将从该描述符池分配的所有描述符集归还给描述符池, 调用前须确保这些描述符集不在执行中
+		result_t Reset() const {
+			VkResult result = vkResetDescriptorPool(graphicsBase::Base().Device(), handle, 0);
+			if (result)
+				outStream << std::format("[ descriptorPool ] ERROR\nFailed to reset a descriptor pool!\nError code: {}\n", int32_t(result));
+			return result;
+		}
+
+		//Non-const Function
+		result_t Create(VkDescriptorPoolCreateInfo& createInfo) {
+			createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+			VkResult result = vkCreateDescriptorPool(graphicsBase::Base().Device(), &createInfo, nullptr, &handle);
+			if (result)
+				outStream << std::format("[ descriptorPool ] ERROR\nFailed to create a descriptor pool!\nError code: {}\n", int32_t(result));
+			return result;
+		}
+
+		result_t Create(uint32_t maxSetCount, arrayRef<const VkDescriptorPoolSize> poolSizes, VkDescriptorPoolCreateFlags flags = 0) {
+			VkDescriptorPoolCreateInfo createInfo = {
+				.flags = flags,
+				.maxSets = maxSetCount,
+				.poolSizeCount = uint32_t(poolSizes.Count()),
+				.pPoolSizes = poolSizes.Pointer()
+			};
+			return Create(createInfo);
+		}
 	};
 
 }
@@ -41,6 +41,10 @@ namespace vulkan {
         VkPipelineDynamicStateCreateInfo dynamicStateCi =
         { VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO };
         std::vector<VkDynamicState> dynamicStates;
+        //Rendering, createInfo.renderPass为VK_NULL_HANDLE时（动态渲染）由其指定附件的格式
+        VkPipelineRenderingCreateInfo renderingCi =
+        { VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO };
+        std::vector<VkFormat> colorAttachmentFormats;
 
         //--------------------
         graphicsPipelineCreateInfoPack() {
@@ -61,6 +65,9 @@ namespace vulkan {
             depthStencilStateCi = other.depthStencilStateCi;
             colorBlendStateCi = other.colorBlendStateCi;
             dynamicStateCi = other.dynamicStateCi;
+            renderingCi = other.renderingCi;
+            if (other.createInfo.pNext == &other.renderingCi)
+                createInfo.pNext = &renderingCi;
 
             shaderStages = other.shaderStages;
             vertexInputBindings = other.vertexInputBindings;
@@ -69,6 +76,7 @@ namespace vulkan {
             scissors = other.scissors;
             colorBlendAttachmentStates = other.colorBlendAttachmentStates;
             dynamicStates = other.dynamicStates;
+            colorAttachmentFormats = other.colorAttachmentFormats;
             UpdateAllArrayAddresses();
         }
 
@@ -84,6 +92,7 @@ namespace vulkan {
             viewportStateCi.scissorCount = scissors.size() ? uint32_t(scissors.size()) : dynamicScissorCount;
             colorBlendStateCi.attachmentCount = colorBlendAttachmentStates.size();
             dynamicStateCi.dynamicStateCount = dynamicStates.size();
+            renderingCi.colorAttachmentCount = colorAttachmentFormats.size();
             UpdateAllArrayAddresses();
         }
     private:
@@ -107,6 +116,2824 @@ namespace vulkan {
             viewportStateCi.pScissors = scissors.data();
             colorBlendStateCi.pAttachments = colorBlendAttachmentStates.data();
             dynamicStateCi.pDynamicStates = dynamicStates.data();
+            renderingCi.pColorAttachmentFormats = colorAttachmentFormats.data();
+            // 不使用渲染通道时, 将renderingCi接到createInfo的pNext链首
+            if (!createInfo.renderPass && createInfo.pNext != &renderingCi)
+                renderingCi.pNext = createInfo.pNext,
+                createInfo.pNext = &renderingCi;
+        }
+    };
+
+    // 按队列合批的提交器, 在一帧中累积命令缓冲区及其需等待和置位的信号量, 在Flush()时以单次vkQueueSubmit（若可用则为vkQueueSubmit2或vkQueueSubmit2KHR）提交
+    // 等待的信号量及阶段与前一个提交相同的提交（如均没有等待）会被并入前一个没有置位信号量的提交, 其余的提交各自对应一个VkSubmitInfo
+    class submissionBatcher {
+        struct batch {
+            uint32_t firstCommandBuffer;
+            uint32_t commandBufferCount;
+            uint32_t firstWait;
+            uint32_t waitCount;
+            uint32_t firstSignal;
+            uint32_t signalCount;
+        };
+        VkQueue queue = VK_NULL_HANDLE;
+        PFN_vkQueueSubmit2 pQueueSubmit2 = nullptr;
+        std::vector<VkCommandBuffer> commandBuffers;
+        std::vector<semaphoreSubmitInfo> waitSemaphores;
+        std::vector<semaphoreSubmitInfo> signalSemaphores;
+        std::vector<batch> batches;
+        // 统计
+        uint64_t addCount = 0;
+        uint64_t queueSubmitCount = 0;
+        //--------------------
+        result_t Flush_Legacy(VkFence fence) {
+            size_t semaphoreCount = waitSemaphores.size() + signalSemaphores.size();
+            std::vector<VkSemaphore> semaphores(semaphoreCount);
+            std::vector<uint64_t> values(semaphoreCount);
+            std::vector<VkPipelineStageFlags> waitDstStages(waitSemaphores.size());
+            for (size_t i = 0; i < waitSemaphores.size(); i++)
+                semaphores[i] = waitSemaphores[i].semaphore,
+                values[i] = waitSemaphores[i].value,
+                waitDstStages[i] = waitSemaphores[i].stage;
+            for (size_t i = 0; i < signalSemaphores.size(); i++)
+                semaphores[waitSemaphores.size() + i] = signalSemaphores[i].semaphore,
+                values[waitSemaphores.size() + i] = signalSemaphores[i].value;
+            bool useTimelineSemaphore = graphicsBase::Base().PhysicalDeviceVulkan12Features().timelineSemaphore;
+            std::vector<VkTimelineSemaphoreSubmitInfo> timelineSemaphoreSubmitInfos(batches.size());
+            std::vector<VkSubmitInfo> submitInfos(batches.size());
+            for (size_t i = 0; i < batches.size(); i++) {
+                auto& b = batches[i];
+                size_t firstSignal = waitSemaphores.size() + b.firstSignal;
+                timelineSemaphoreSubmitInfos[i] = {
+                    .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+                    .waitSemaphoreValueCount = b.waitCount,
+                    .pWaitSemaphoreValues = values.data() + b.firstWait,
+                    .signalSemaphoreValueCount = b.signalCount,
+                    .pSignalSemaphoreValues = values.data() + firstSignal
+                };
+                submitInfos[i] = {
+                    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+                    .pNext = useTimelineSemaphore ? &timelineSemaphoreSubmitInfos[i] : nullptr,
+                    .waitSemaphoreCount = b.waitCount,
+                    .pWaitSemaphores = semaphores.data() + b.firstWait,
+                    .pWaitDstStageMask = waitDstStages.data() + b.firstWait,
+                    .commandBufferCount = b.commandBufferCount,
+                    .pCommandBuffers = commandBuffers.data() + b.firstCommandBuffer,
+                    .signalSemaphoreCount = b.signalCount,
+                    .pSignalSemaphores = semaphores.data() + firstSignal
+                };
+            }
+            VkResult result = vkQueueSubmit(queue, uint32_t(submitInfos.size()), submitInfos.data(), fence);
+            if (result)
+                outStream << std::format("[ submissionBatcher ] ERROR\nFailed to submit the command buffers!\nError code: {}\n", int32_t(result));
+            return result;
+        }
+        result_t Flush_Synchronization2(VkFence fence) {
+            std::vector<VkSemaphoreSubmitInfo> semaphoreInfos(waitSemaphores.size() + signalSemaphores.size());
+            for (size_t i = 0; i < waitSemaphores.size(); i++)
+                semaphoreInfos[i] = {
+                    .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+                    .semaphore = waitSemaphores[i].semaphore,
+                    .value = waitSemaphores[i].value,
+                    .stageMask = VkPipelineStageFlags2(waitSemaphores[i].stage)
+                };
+            for (size_t i = 0; i < signalSemaphores.size(); i++)
+                semaphoreInfos[waitSemaphores.size() + i] = {
+                    .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+                    .semaphore = signalSemaphores[i].semaphore,
+                    .value = signalSemaphores[i].value,
+                    .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT
+                };
+            std::vector<VkCommandBufferSubmitInfo> commandBufferInfos(commandBuffers.size());
+            for (size_t i = 0; i < commandBuffers.size(); i++)
+                commandBufferInfos[i] = {
+                    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+                    .commandBuffer = commandBuffers[i]
+                };
+            std::vector<VkSubmitInfo2> submitInfos(batches.size());
+            for (size_t i = 0; i < batches.size(); i++) {
+                auto& b = batches[i];
+                submitInfos[i] = {
+                    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+                    .waitSemaphoreInfoCount = b.waitCount,
+                    .pWaitSemaphoreInfos = semaphoreInfos.data() + b.firstWait,
+                    .commandBufferInfoCount = b.commandBufferCount,
+                    .pCommandBufferInfos = commandBufferInfos.data() + b.firstCommandBuffer,
+                    .signalSemaphoreInfoCount = b.signalCount,
+                    .pSignalSemaphoreInfos = semaphoreInfos.data() + waitSemaphores.size() + b.firstSignal
+                };
+            }
+            VkResult result = pQueueSubmit2(queue, uint32_t(submitInfos.size()), submitInfos.data(), fence);
+            if (result)
+                outStream << std::format("[ submissionBatcher ] ERROR\nFailed to submit the command buffers!\nError code: {}\n", int32_t(result));
+            return result;
+        }
+        bool SameWaits_Internal(const batch& b, arrayRef<const semaphoreSubmitInfo> waitSemaphores) const {
+            if (b.waitCount != waitSemaphores.Count())
+                return false;
+            for (uint32_t i = 0; i < b.waitCount; i++) {
+                auto& a = this->waitSemaphores[b.firstWait + i];
+                if (a.semaphore != waitSemaphores[i].semaphore ||
+                    a.value != waitSemaphores[i].value ||
+                    a.stage != waitSemaphores[i].stage)
+                    return false;
+            }
+            return true;
+        }
+    public:
+        submissionBatcher() = default;
+        submissionBatcher(VkQueue queue) {
+            Init(queue);
+        }
+        submissionBatcher(submissionBatcher&&) = delete;
+        //Getter
+        VkQueue Queue() const {
+            return queue;
+        }
+        uint32_t PendingBatchCount() const {
+            return uint32_t(batches.size());
+        }
+        // 累计调用Add(...)的次数与实际调用vkQueueSubmit的次数之差, 即合批所节省的提交次数
+        uint64_t SubmitsSaved() const {
+            return addCount - queueSubmitCount;
+        }
+        uint64_t QueueSubmitCount() const {
+            return queueSubmitCount;
+        }
+        //Non-const Function
+        // 开启了Vulkan1.3的synchronization2特性时使用vkQueueSubmit2, 开启了VK_KHR_synchronization2时使用vkQueueSubmit2KHR
+        void Init(VkQueue queue) {
+            this->queue = queue;
+            pQueueSubmit2 = nullptr;
+            if (graphicsBase::Base().DeviceApiVersion() >= VK_API_VERSION_1_3 && graphicsBase::Base().PhysicalDeviceVulkan13Features().synchronization2)
+                pQueueSubmit2 = reinterpret_cast<PFN_vkQueueSubmit2>(vkGetDeviceProcAddr(graphicsBase::Base().Device(), "vkQueueSubmit2"));
+            else if (graphicsBase::Base().IsDeviceExtensionEnabled(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME))
+                pQueueSubmit2 = reinterpret_cast<PFN_vkQueueSubmit2>(vkGetDeviceProcAddr(graphicsBase::Base().Device(), "vkQueueSubmit2KHR"));
+        }
+        // 累积一次提交, 直到Flush()才真正提交到队列
+        void Add(arrayRef<const VkCommandBuffer> commandBuffers,
+            arrayRef<const semaphoreSubmitInfo> waitSemaphores = {}, arrayRef<const semaphoreSubmitInfo> signalSemaphores = {}) {
+            addCount++;
+            // 信号量置位操作的同步范围包含提交顺序在其之前的全部命令, 因此等待（含等待的阶段）与前一个提交相同的提交可以并入前一个没有置位信号量的提交, 语义不变
+            // 等待不同时不能合并（如没有等待的提交跟在有等待的提交之后）, 否则其命令缓冲区会继承前一个提交的等待
+            if (batches.size() &&
+                !batches.back().signalCount &&
+                SameWaits_Internal(batches.back(), waitSemaphores))
+                // 并入时沿用前一个提交的等待, 不重复记录
+                batches.back().commandBufferCount += uint32_t(commandBuffers.Count()),
+                batches.back().firstSignal = uint32_t(this->signalSemaphores.size()),
+                batches.back().signalCount = uint32_t(signalSemaphores.Count());
+            else
+                batches.push_back({
+                    uint32_t(this->commandBuffers.size()), uint32_t(commandBuffers.Count()),
+                    uint32_t(this->waitSemaphores.size()), uint32_t(waitSemaphores.Count()),
+                    uint32_t(this->signalSemaphores.size()), uint32_t(signalSemaphores.Count()) }),
+                this->waitSemaphores.insert(this->waitSemaphores.end(), waitSemaphores.begin(), waitSemaphores.end());
+            this->commandBuffers.insert(this->commandBuffers.end(), commandBuffers.begin(), commandBuffers.end());
+            this->signalSemaphores.insert(this->signalSemaphores.end(), signalSemaphores.begin(), signalSemaphores.end());
+        }
+        void Add(VkCommandBuffer commandBuffer,
+            arrayRef<const semaphoreSubmitInfo> waitSemaphores = {}, arrayRef<const semaphoreSubmitInfo> signalSemaphores = {}) {
+            Add(arrayRef<const VkCommandBuffer>(commandBuffer), waitSemaphores, signalSemaphores);
+        }
+        // 将累积的提交以单次调用提交到队列, fence在其中所有命令执行完后被置位
+        result_t Flush(VkFence fence = VK_NULL_HANDLE) {
+            if (batches.empty() && !fence)
+                return VK_SUCCESS;
+            VkResult result = pQueueSubmit2 ? Flush_Synchronization2(fence) : Flush_Legacy(fence);
+            if (batches.size())
+                queueSubmitCount++;
+            commandBuffers.clear();
+            waitSemaphores.clear();
+            signalSemaphores.clear();
+            batches.clear();
+            return result;
+        }
+    };
+
+    // GPU时间戳分析器, 在命令缓冲区中写入成对的时间戳, 以测量各个范围（如某个渲染通道）的GPU耗时
+    // 查询池按帧环形使用, 每帧读回的是ringSize帧之前、已执行完毕的结果, 因而不会阻塞, ringSize应与即时帧的数量相同
+    class gpuProfiler {
+    public:
+        // 以毫秒计
+        struct scopeStatistics {
+            double latest = 0;
+            double min = std::numeric_limits<double>::max();
+            double max = 0;
+            double total = 0;
+            uint64_t sampleCount = 0;
+            double Average() const {
+                return sampleCount ? total / sampleCount : 0;
+            }
+        };
+        // 构造时写入起始时间戳, 析构时写入结束时间戳
+        class scope {
+            gpuProfiler& profiler;
+            VkCommandBuffer commandBuffer;
+            uint32_t index;
+        public:
+            scope(gpuProfiler& profiler, VkCommandBuffer commandBuffer, const char* name) :
+                profiler(profiler), commandBuffer(commandBuffer), index(profiler.CmdBeginScope(commandBuffer, name)) {}
+            scope(scope&&) = delete;
+            ~scope() { profiler.CmdEndScope(commandBuffer, index); }
+        };
+    private:
+        struct frameQueries {
+            vulkan::queryPool queryPool;
+            // 各范围的名称, 须在结果被读回前保持有效, 通常为字符串字面量
+            std::vector<const char*> names;
+        };
+        std::vector<frameQueries> frames;
+        uint32_t currentFrame = 0;
+        uint32_t maxScopeCount = 0;
+        // 每个时间戳计数所对应的纳秒数
+        double timestampPeriod = 1;
+        uint64_t timestampMask = 0;
+        std::vector<uint64_t> results;
+        std::map<std::string, scopeStatistics, std::less<>> statistics;
+        //--------------------
+        void ReadBack(frameQueries& frame) {
+            uint32_t queryCount = uint32_t(frame.names.size()) * 2;
+            if (!queryCount)
+                return;
+            // 每个查询得到两个值：时间戳及其可用性
+            if (frame.queryPool.GetResults(0, queryCount, queryCount * 2 * sizeof(uint64_t), results.data(), 2 * sizeof(uint64_t),
+                VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT) < 0)
+                return;
+            for (size_t i = 0; i < frame.names.size(); i++) {
+                const uint64_t* pBegin = &results[i * 4];
+                const uint64_t* pEnd = &results[i * 4 + 2];
+                if (!pBegin[1] || !pEnd[1])
+                    continue;
+                double milliseconds = double((pEnd[0] - pBegin[0]) & timestampMask) * timestampPeriod * 1e-6;
+                auto iterator = statistics.find(frame.names[i]);
+                if (iterator == statistics.end())
+                    iterator = statistics.emplace(frame.names[i], scopeStatistics{}).first;
+                auto& statistic = iterator->second;
+                statistic.latest = milliseconds;
+                statistic.min = std::min(statistic.min, milliseconds);
+                statistic.max = std::max(statistic.max, milliseconds);
+                statistic.total += milliseconds;
+                statistic.sampleCount++;
+            }
+        }
+    public:
+        gpuProfiler() = default;
+        gpuProfiler(uint32_t ringSize, uint32_t maxScopeCount = 64) {
+            Create(ringSize, maxScopeCount);
+        }
+        gpuProfiler(gpuProfiler&&) = delete;
+        //Getter
+        // 图形队列不支持时间戳时, 各Cmd函数不做任何事
+        bool IsSupported() const {
+            return timestampMask;
+        }
+        const std::map<std::string, scopeStatistics, std::less<>>& Statistics() const {
+            return statistics;
+        }
+        //Const Function
+        // 以表格形式输出各范围的统计结果
+        std::string Report() const {
+            std::string report = std::format("{:<24}{:>10}{:>10}{:>10}{:>10}\n", "GPU scope (ms)", "latest", "min", "avg", "max");
+            for (auto& [name, statistic] : statistics)
+                report += std::format("{:<24}{:>10.3f}{:>10.3f}{:>10.3f}{:>10.3f}\n", name, statistic.latest, statistic.min, statistic.Average(), statistic.max);
+            return report;
+        }
+        //Non-const Function
+        void Create(uint32_t ringSize, uint32_t maxScopeCount = 64) {
+            uint32_t queueFamilyCount = 0;
+            vkGetPhysicalDeviceQueueFamilyProperties(graphicsBase::Base().PhysicalDevice(), &queueFamilyCount, nullptr);
+            std::vector<VkQueueFamilyProperties> queueFamilyPropertieses(queueFamilyCount);
+            vkGetPhysicalDeviceQueueFamilyProperties(graphicsBase::Base().PhysicalDevice(), &queueFamilyCount, queueFamilyPropertieses.data());
+            uint32_t timestampValidBits = queueFamilyPropertieses[graphicsBase::Base().QueueFamilyIndex_Graphics()].timestampValidBits;
+            if (!timestampValidBits) {
+                outStream << std::format("[ gpuProfiler ] WARNING\nTimestamps are not supported by the graphics queue!\n");
+                return;
+            }
+            timestampMask = timestampValidBits >= 64 ? UINT64_MAX : (uint64_t(1) << timestampValidBits) - 1;
+            timestampPeriod = graphicsBase::Base().PhysicalDeviceProperties().limits.timestampPeriod;
+            this->maxScopeCount = maxScopeCount;
+            frames.resize(ringSize);
+            for (auto& i : frames)
+                i.queryPool.Create(VK_QUERY_TYPE_TIMESTAMP, maxScopeCount * 2),
+                i.names.reserve(maxScopeCount);
+            results.resize(maxScopeCount * 4);
+        }
+        // 在每帧开始录制命令时（渲染通道外）调用, 读回当前槽位上一轮的结果并重置其查询
+        void CmdBeginFrame(VkCommandBuffer commandBuffer) {
+            if (!IsSupported())
+                return;
+            currentFrame = (currentFrame + 1) % uint32_t(frames.size());
+            auto& frame = frames[currentFrame];
+            ReadBack(frame);
+            frame.names.clear();
+            frame.queryPool.CmdReset(commandBuffer, 0, maxScopeCount * 2);
+        }
+        // 返回范围的索引, 超出maxScopeCount时返回UINT32_MAX且不写入时间戳
+        uint32_t CmdBeginScope(VkCommandBuffer commandBuffer, const char* name) {
+            if (!IsSupported())
+                return UINT32_MAX;
+            auto& frame = frames[currentFrame];
+            if (frame.names.size() == maxScopeCount)
+                return UINT32_MAX;
+            uint32_t index = uint32_t(frame.names.size());
+            frame.names.push_back(name);
+            frame.queryPool.CmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, index * 2);
+            return index;
+        }
+        void CmdEndScope(VkCommandBuffer commandBuffer, uint32_t index) {
+            if (index == UINT32_MAX)
+                return;
+            frames[currentFrame].queryPool.CmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, index * 2 + 1);
+        }
+        void ResetStatistics() {
+            statistics.clear();
+        }
+    };
+
+    // 持久映射的逐帧上传环形缓冲区, 用于每帧更新的uniform、动态顶点、实例数据等, 每次分配仅是移动偏移量, 不映射内存亦不分配内存
+    // 缓冲区被分为regionCount个区域（通常与即时帧的数量相同）, 每帧在对应区域内线性分配, 该区域在该帧的栅栏被等待后才被重用
+    class uploadRing {
+    public:
+        static constexpr VkBufferUsageFlags defaultUsage =
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+            VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+        struct suballocation {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceSize offset = 0;
+            void* pData = nullptr;
+            //--------------------
+            explicit operator bool() const { return pData; }
+        };
+    private:
+        vulkan::buffer buffer;
+        VkDeviceSize regionSize = 0;
+        uint32_t regionCount = 0;
+        uint32_t currentRegion = 0;
+        // 当前区域中已分配的大小, 及其中已刷新的大小
+        VkDeviceSize allocatedSize = 0;
+        VkDeviceSize flushedSize = 0;
+        // 未指定对齐时所用的对齐, 满足缓冲区用途所对应的min*OffsetAlignment
+        VkDeviceSize defaultAlignment = 16;
+    public:
+        uploadRing() = default;
+        uploadRing(VkDeviceSize regionSize, uint32_t regionCount, VkBufferUsageFlags usage = defaultUsage) {
+            Create(regionSize, regionCount, usage);
+        }
+        uploadRing(uploadRing&&) = delete;
+        //Getter
+        VkBuffer Buffer() const {
+            return buffer;
+        }
+        VkDeviceSize RegionSize() const {
+            return regionSize;
+        }
+        VkDeviceSize AllocatedSize() const {
+            return allocatedSize;
+        }
+        VkDeviceSize DefaultAlignment() const {
+            return defaultAlignment;
+        }
+        //Non-const Function
+        // 开始在frameIndex对应的区域中分配, 调用前须确保该区域先前的内容已不被GPU使用（如已等待frameContext中对应槽位的栅栏）
+        void BeginFrame(uint32_t frameIndex) {
+            currentRegion = frameIndex % regionCount;
+            allocatedSize = flushedSize = 0;
+        }
+        // alignment为0时使用defaultAlignment, 当前区域的空间不足时返回空的suballocation
+        suballocation Allocate(VkDeviceSize size, VkDeviceSize alignment = 0) {
+            if (!alignment)
+                alignment = defaultAlignment;
+            VkDeviceSize offset = (allocatedSize + alignment - 1) / alignment * alignment;
+            if (offset + size > regionSize) {
+                outStream << std::format("[ uploadRing ] ERROR\nOut of space! Region size: {}, requested: {} at offset {}\n", regionSize, size, offset);
+                return {};
+            }
+            allocatedSize = offset + size;
+            offset += currentRegion * regionSize;
+            return { buffer, offset, static_cast<uint8_t*>(buffer.MappedData()) + offset };
+        }
+        suballocation Upload(const void* pData, VkDeviceSize size, VkDeviceSize alignment = 0) {
+            suballocation suballocation = Allocate(size, alignment);
+            if (suballocation)
+                memcpy(suballocation.pData, pData, size_t(size));
+            return suballocation;
+        }
+        // 上传单个对象或定长数组
+        template<typename T>
+            requires (std::is_trivially_copyable_v<T> && !std::is_pointer_v<T>)
+        suballocation Upload(const T& data, VkDeviceSize alignment = 0) {
+            return Upload(&data, sizeof data, alignment);
+        }
+        // 将当前区域中自上次刷新后写入的部分作为一个范围一并刷新, 在提交读取这些数据的命令前调用, 内存为host coherent时什么也不做
+        result_t Flush() {
+            if (flushedSize == allocatedSize)
+                return VK_SUCCESS;
+            VkResult result = buffer.Flush(currentRegion * regionSize + flushedSize, allocatedSize - flushedSize);
+            if (!result)
+                flushedSize = allocatedSize;
+            return result;
+        }
+        result_t Create(VkDeviceSize regionSize, uint32_t regionCount, VkBufferUsageFlags usage = defaultUsage) {
+            auto& limits = graphicsBase::Base().PhysicalDeviceProperties().limits;
+            defaultAlignment = 16;
+            if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
+                defaultAlignment = std::max(defaultAlignment, limits.minUniformBufferOffsetAlignment);
+            if (usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+                defaultAlignment = std::max(defaultAlignment, limits.minStorageBufferOffsetAlignment);
+            if (usage & (VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT))
+                defaultAlignment = std::max(defaultAlignment, limits.minTexelBufferOffsetAlignment);
+            // 区域的边界对齐到nonCoherentAtomSize, 使刷新一个区域时不涉及相邻区域
+            VkDeviceSize regionAlignment = std::max(defaultAlignment, limits.nonCoherentAtomSize);
+            this->regionSize = (regionSize + regionAlignment - 1) / regionAlignment * regionAlignment;
+            this->regionCount = regionCount;
+            currentRegion = 0;
+            allocatedSize = flushedSize = 0;
+            if (VkResult result = buffer.Create(this->regionSize * regionCount, usage, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+                return result;
+            if (!buffer.MappedData()) {
+                outStream << std::format("[ uploadRing ] ERROR\nThe buffer is not mapped!\n");
+                return VK_RESULT_MAX_ENUM;
+            }
+            return VK_SUCCESS;
+        }
+    };
+
+    // 异步上传引擎, 在数据传送队列（见graphicsBase::Queue_Transfer()）上将数据经暂存缓冲区复制到device local的缓冲区和图像
+    // 存在专用的数据传送队列族时, 资源的所有权在上传后由其释放, 须在图形队列的命令缓冲区中以CmdAcquireOwnership(...)获取, 与CmdTransferImageOwnership(...)同理
+    // 每批上传完成后置位时间线信号量, 图形队列的提交通过SemaphoreToWait(...)等待之; 不支持时间线信号量时改为置位各批次的二值信号量, Submit()同样不阻塞
+    // 非线程安全, 须在同一线程中调用
+    class asyncUploader {
+        struct batch {
+            vulkan::commandBuffer commandBuffer;
+            vulkan::fence fence;
+            // 已提交且尚未被等待, 提交失败时不被置为true, 以免等待一个永远不会被置位的栅栏
+            bool inFlight = false;
+            // 该批上传所用的暂存缓冲区, 在该批重用前释放
+            std::vector<vulkan::buffer> stagingBuffers;
+            // 不支持时间线信号量时, 该批上传完成后置位的二值信号量
+            std::unique_ptr<vulkan::semaphore> semaphore_binary;
+            // 二值信号量已被置位, 但尚未经SemaphoreToWait(...)交给等待方
+            bool semaphoreUnclaimed = false;
+        };
+        // 与释放所有权的屏障对应的获取所有权的屏障, value为释放所有权的那一批上传所置位的值
+        struct ownershipAcquisition {
+            uint64_t value = 0;
+            VkPipelineStageFlags dstStage = 0;
+            std::vector<VkBufferMemoryBarrier> bufferMemoryBarriers;
+            std::vector<VkImageMemoryBarrier> imageMemoryBarriers;
+        };
+        vulkan::commandPool commandPool;
+        std::vector<batch> batches;
+        std::unique_ptr<timelineSemaphore> semaphore_timeline;
+        uint32_t currentBatch = 0;
+        bool recording = false;
+        // 最近一次提交的批次所置位的值, 首个批次置位1
+        uint64_t submittedValue = 0;
+        ownershipAcquisition recordingAcquisition;
+        std::vector<ownershipAcquisition> pendingAcquisitions;
+        //--------------------
+        bool TransfersOwnership() const {
+            return graphicsBase::Base().QueueFamilyIndex_Transfer() != graphicsBase::Base().QueueFamilyIndex_Graphics();
+        }
+        // 首次上传时开始录制当前批次, 若该批次仍在执行则等待之
+        result_t BeginBatch_Internal() {
+            if (recording)
+                return VK_SUCCESS;
+            auto& current = batches[currentBatch];
+            if (current.inFlight) {
+                if (VkResult result = current.fence.Wait())
+                    return result;
+                if (VkResult result = current.fence.Reset())
+                    return result;
+                current.inFlight = false;
+            }
+            // 未被等待的二值信号量保持置位状态, 不能再次置位; 其置位操作已随栅栏完成, 可直接重建
+            if (current.semaphoreUnclaimed)
+                current.semaphore_binary = std::make_unique<vulkan::semaphore>(),
+                current.semaphoreUnclaimed = false;
+            current.stagingBuffers.clear();
+            if (VkResult result = current.commandBuffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT))
+                return result;
+            recording = true;
+            return VK_SUCCESS;
+        }
+        // 创建暂存缓冲区并写入数据, 返回其handle
+        VkBuffer Stage_Internal(const void* pData, VkDeviceSize size) {
+            vulkan::buffer stagingBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+            if (!stagingBuffer.MappedData()) {
+                outStream << std::format("[ asyncUploader ] ERROR\nFailed to create a staging buffer of {} bytes!\n", size);
+                return VK_NULL_HANDLE;
+            }
+            memcpy(stagingBuffer.MappedData(), pData, size_t(size));
+            stagingBuffer.Flush();
+            VkBuffer handle = stagingBuffer;
+            batches[currentBatch].stagingBuffers.push_back(std::move(stagingBuffer));
+            return handle;
+        }
+    public:
+        asyncUploader(uint32_t batchCount = 2) {
+            Create(batchCount);
+        }
+        asyncUploader(asyncUploader&&) = delete;
+        ~asyncUploader() {
+            WaitIdle();
+        }
+        //Getter
+        VkSemaphore TimelineSemaphore() const {
+            return semaphore_timeline ? VkSemaphore(*semaphore_timeline) : VK_NULL_HANDLE;
+        }
+        uint64_t SubmittedValue() const {
+            return submittedValue;
+        }
+        //Const Function
+        // 不阻塞地查询置位value的那一批上传是否已完成
+        bool IsComplete(uint64_t value) const {
+            if (value > submittedValue)
+                return false;
+            if (semaphore_timeline)
+                return semaphore_timeline->Value() >= value;
+            // 不支持时间线信号量时查询该批次的栅栏, 批次已被重用则必已完成
+            if (submittedValue - value >= batches.size())
+                return true;
+            auto& b = batches[(value - 1) % batches.size()];
+            return !b.inFlight || b.fence.Status() != VK_NOT_READY;
+        }
+        //Non-const Function
+        // 供图形队列的提交（如SubmitCommandBuffer_Graphics的多信号量版本）等待最近一次提交的上传（亦涵盖同一队列上先前提交的各批上传）
+        // 不支持时间线信号量时返回最近一批的二值信号量, 每次提交只返回一次, 调用方须确实等待之; 无需等待时semaphore为VK_NULL_HANDLE
+        semaphoreSubmitInfo SemaphoreToWait(VkPipelineStageFlags stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT) {
+            if (!submittedValue)
+                return {};
+            if (semaphore_timeline)
+                return { *semaphore_timeline, submittedValue, stage };
+            auto& last = batches[(currentBatch + batches.size() - 1) % batches.size()];
+            if (!last.semaphoreUnclaimed)
+                return {};
+            last.semaphoreUnclaimed = false;
+            return { *last.semaphore_binary, 0, stage };
+        }
+        // 将size字节的数据上传到dstBuffer中dstOffset处, dstStage和dstAccess为图形队列上首次使用该数据的阶段和访问方式
+        result_t UploadBuffer(VkBuffer dstBuffer, const void* pData, VkDeviceSize size, VkDeviceSize dstOffset,
+            VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) {
+            if (VkResult result = BeginBatch_Internal())
+                return result;
+            VkBuffer stagingBuffer = Stage_Internal(pData, size);
+            if (!stagingBuffer)
+                return VK_RESULT_MAX_ENUM;
+            VkCommandBuffer commandBuffer = batches[currentBatch].commandBuffer;
+            VkBufferCopy region = { 0, dstOffset, size };
+            vkCmdCopyBuffer(commandBuffer, stagingBuffer, dstBuffer, 1, &region);
+            VkBufferMemoryBarrier bufferMemoryBarrier = {
+                .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .dstAccessMask = dstAccess,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .buffer = dstBuffer,
+                .offset = dstOffset,
+                .size = size
+            };
+            if (TransfersOwnership()) {
+                // 释放所有权, 释放一方的dstAccessMask被忽略
+                bufferMemoryBarrier.dstAccessMask = 0;
+                bufferMemoryBarrier.srcQueueFamilyIndex = graphicsBase::Base().QueueFamilyIndex_Transfer();
+                bufferMemoryBarrier.dstQueueFamilyIndex = graphicsBase::Base().QueueFamilyIndex_Graphics();
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                    0, nullptr, 1, &bufferMemoryBarrier, 0, nullptr);
+                // 获取所有权, 获取一方的srcAccessMask被忽略
+                bufferMemoryBarrier.srcAccessMask = 0;
+                bufferMemoryBarrier.dstAccessMask = dstAccess;
+                recordingAcquisition.dstStage |= dstStage;
+                recordingAcquisition.bufferMemoryBarriers.push_back(bufferMemoryBarrier);
+            }
+            else
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStage, 0,
+                    0, nullptr, 1, &bufferMemoryBarrier, 0, nullptr);
+            return VK_SUCCESS;
+        }
+        // 将size字节的数据上传到dstImage中由subresource指定的mip等级和图层, 数据紧密排列, 图像的原有内容被丢弃, 上传后转到finalLayout
+        result_t UploadImage(VkImage dstImage, const void* pData, VkDeviceSize size, VkExtent3D extent, VkImageSubresourceLayers subresource,
+            VkImageLayout finalLayout, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) {
+            if (VkResult result = BeginBatch_Internal())
+                return result;
+            VkBuffer stagingBuffer = Stage_Internal(pData, size);
+            if (!stagingBuffer)
+                return VK_RESULT_MAX_ENUM;
+            VkCommandBuffer commandBuffer = batches[currentBatch].commandBuffer;
+            VkImageSubresourceRange subresourceRange = {
+                subresource.aspectMask, subresource.mipLevel, 1, subresource.baseArrayLayer, subresource.layerCount
+            };
+            VkImageMemoryBarrier imageMemoryBarrier = {
+                .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                .srcAccessMask = 0,
+                .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+                .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image = dstImage,
+                .subresourceRange = subresourceRange
+            };
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+            VkBufferImageCopy region = {
+                .imageSubresource = subresource,
+                .imageExtent = extent
+            };
+            vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+            // 布局转换随所有权转移一并进行, 释放和获取的两个屏障中的布局须一致
+            imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            imageMemoryBarrier.dstAccessMask = dstAccess;
+            imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            imageMemoryBarrier.newLayout = finalLayout;
+            if (TransfersOwnership()) {
+                imageMemoryBarrier.dstAccessMask = 0;
+                imageMemoryBarrier.srcQueueFamilyIndex = graphicsBase::Base().QueueFamilyIndex_Transfer();
+                imageMemoryBarrier.dstQueueFamilyIndex = graphicsBase::Base().QueueFamilyIndex_Graphics();
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                    0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+                imageMemoryBarrier.srcAccessMask = 0;
+                imageMemoryBarrier.dstAccessMask = dstAccess;
+                recordingAcquisition.dstStage |= dstStage;
+                recordingAcquisition.imageMemoryBarriers.push_back(imageMemoryBarrier);
+            }
+            else
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStage, 0,
+                    0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+            return VK_SUCCESS;
+        }
+        // 提交当前批次的上传, 没有待提交的上传时什么也不做, 该批次所置位的值见SubmittedValue()
+        result_t Submit() {
+            if (!recording)
+                return VK_SUCCESS;
+            recording = false;
+            auto& current = batches[currentBatch];
+            // 提交失败时丢弃该批次, 其上传的目标资源的内容未定义
+            ownershipAcquisition acquisition = std::move(recordingAcquisition);
+            recordingAcquisition = {};
+            if (VkResult result = current.commandBuffer.End())
+                return result;
+            uint64_t value = submittedValue + 1;
+            VkResult result = VK_SUCCESS;
+            if (semaphore_timeline) {
+                semaphoreSubmitInfo signalSemaphore = { *semaphore_timeline, value };
+                result = graphicsBase::Base().SubmitCommandBuffer_Transfer(current.commandBuffer, {}, signalSemaphore, current.fence);
+            }
+            else {
+                semaphoreSubmitInfo signalSemaphore = { *current.semaphore_binary };
+                result = graphicsBase::Base().SubmitCommandBuffer_Transfer(current.commandBuffer, {}, signalSemaphore, current.fence);
+            }
+            if (result)
+                return result;
+            current.inFlight = true;
+            current.semaphoreUnclaimed = !semaphore_timeline;
+            submittedValue = value;
+            currentBatch = (currentBatch + 1) % batches.size();
+            if (acquisition.bufferMemoryBarriers.size() ||
+                acquisition.imageMemoryBarriers.size()) {
+                acquisition.value = value;
+                pendingAcquisitions.push_back(std::move(acquisition));
+            }
+            return VK_SUCCESS;
+        }
+        // 在图形队列的命令缓冲区中录制获取所有权的屏障, 包含已提交但尚未获取所有权的所有上传, 没有专用的数据传送队列族时什么也不做
+        // 该命令缓冲区所在的提交须等待SemaphoreToWait(...)
+        void CmdAcquireOwnership(VkCommandBuffer commandBuffer) {
+            for (auto& i : pendingAcquisitions)
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, i.dstStage, 0,
+                    0, nullptr,
+                    uint32_t(i.bufferMemoryBarriers.size()), i.bufferMemoryBarriers.data(),
+                    uint32_t(i.imageMemoryBarriers.size()), i.imageMemoryBarriers.data());
+            pendingAcquisitions.clear();
+        }
+        // 提交尚未提交的上传, 然后在CPU一侧等待所有上传完成
+        result_t WaitIdle() {
+            if (VkResult result = Submit())
+                return result;
+            for (auto& i : batches) {
+                if (i.inFlight) {
+                    if (VkResult result = i.fence.Wait())
+                        return result;
+                    if (VkResult result = i.fence.Reset())
+                        return result;
+                    i.inFlight = false;
+                }
+                i.stagingBuffers.clear();
+            }
+            return VK_SUCCESS;
+        }
+        result_t Create(uint32_t batchCount = 2) {
+            if (VkResult result = commandPool.Create(graphicsBase::Base().QueueFamilyIndex_Transfer(), VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT))
+                return result;
+            batches = std::vector<batch>(std::max(batchCount, 1u));
+            for (auto& i : batches)
+                if (VkResult result = commandPool.AllocateBuffers(i.commandBuffer))
+                    return result;
+            if (graphicsBase::Base().PhysicalDeviceVulkan12Features().timelineSemaphore)
+                semaphore_timeline = std::make_unique<timelineSemaphore>();
+            else
+                for (auto& i : batches)
+                    i.semaphore_binary = std::make_unique<vulkan::semaphore>();
+            return VK_SUCCESS;
+        }
+    };
+
+    // 多线程贴图流送, 以jobSystem::Default()的任务解码图像文件（经stb_image）并将像素写入暂存缓冲区, 渲染线程在Update(...)中录制复制命令并以vkCmdBlitImage生成mipmap
+    // Request(...)立即返回贴图的索引, 贴图在流送完成前以低分辨率的占位贴图代替; 驻留贴图的总大小超出预算时, 按最近最少使用的顺序驱逐
+    // 各成员函数须在渲染线程中调用
+    class textureStreamer {
+    public:
+        enum residency {
+            residency_loading,  // 正在解码或等待上传
+            residency_resident, // 已上传, 可被采样
+            residency_evicted,  // 已被驱逐, 再次使用时重新流送
+            residency_failed    // 读取失败, 始终使用占位贴图
+        };
+        static constexpr VkFormat defaultFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    private:
+        struct texture {
+            std::string path;
+            textureStreamer::residency residency = residency_loading;
+            vulkan::image image;
+            vulkan::imageView imageView;
+            VkExtent2D extent = {};
+            uint32_t mipLevelCount = 0;
+            VkDeviceSize size = 0;
+            // 最近一次被ImageView(...)访问时的帧序号, 见graphicsBase::FrameNumber()
+            uint64_t lastUsedFrame = 0;
+        };
+        // 解码任务的结果, stagingBuffer中为紧密排列的RGBA8像素
+        struct decodedImage {
+            uint32_t index;
+            VkExtent2D extent;
+            vulkan::buffer stagingBuffer;
+        };
+        VkFormat format = defaultFormat;
+        bool linearBlit = true;
+        VkDeviceSize residencyBudget = 0;
+        VkDeviceSize residentSize = 0;
+        VkDeviceSize uploadBudgetPerFrame = 64 << 20;
+        // 贴图以std::deque存储, 追加时不移动已有元素
+        std::deque<texture> textures;
+        texture placeholder;
+        std::unique_ptr<decodedImage> placeholderPixels;
+        // decodedImages由mutex保护, 在解码任务与渲染线程间共享
+        std::mutex mutex;
+        std::deque<decodedImage> decodedImages;
+        // 尚未完成的解码任务, 析构时须等待其归零
+        jobSystem::counter pendingDecodes;
+        //--------------------
+        // 在任务中执行, path以值传递, 解码任务不访问textures
+        void Decode_Internal(uint32_t index, const std::string& path) {
+            decodedImage decoded = { index };
+            int width = 0, height = 0, channelCount = 0;
+            if (stbi_uc* pPixels = stbi_load(path.c_str(), &width, &height, &channelCount, STBI_rgb_alpha)) {
+                decoded.extent = { uint32_t(width), uint32_t(height) };
+                VkDeviceSize size = VkDeviceSize(width) * height * 4;
+                // 在任务中写入暂存缓冲区, 渲染线程只需录制复制命令, 暂存缓冲区无效时该贴图被视作读取失败
+                if (!decoded.stagingBuffer.Create(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) &&
+                    decoded.stagingBuffer.MappedData()) {
+                    memcpy(decoded.stagingBuffer.MappedData(), pPixels, size_t(size));
+                    decoded.stagingBuffer.Flush();
+                }
+                else
+                    decoded.stagingBuffer.~buffer();
+                stbi_image_free(pPixels);
+            }
+            else
+                outStream << std::format("[ textureStreamer ] ERROR\nFailed to load the file: {}\nReason: {}\n", path, stbi_failure_reason());
+            std::lock_guard lock(mutex);
+            decodedImages.push_back(std::move(decoded));
+        }
+        void Enqueue_Internal(uint32_t index) {
+            textures[index].residency = residency_loading;
+            jobSystem::Default().Run([this, index, path = textures[index].path] { Decode_Internal(index, path); }, &pendingDecodes);
+        }
+        // 创建贴图并录制上传和生成mipmap的命令, 结束时所有mip等级均为VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+        result_t Upload_Internal(VkCommandBuffer commandBuffer, texture& texture, decodedImage& decoded) {
+            texture.extent = decoded.extent;
+            texture.mipLevelCount = linearBlit ? uint32_t(std::bit_width(std::max(decoded.extent.width, decoded.extent.height))) : 1;
+            VkImageCreateInfo imageCreateInfo = {
+                .imageType = VK_IMAGE_TYPE_2D,
+                .format = format,
+                .extent = { decoded.extent.width, decoded.extent.height, 1 },
+                .mipLevels = texture.mipLevelCount,
+                .arrayLayers = 1,
+                .samples = VK_SAMPLE_COUNT_1_BIT,
+                .tiling = VK_IMAGE_TILING_OPTIMAL,
+                .usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT
+            };
+            if (VkResult result = texture.image.Create(imageCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
+                return result;
+            if (VkResult result = texture.imageView.Create(texture.image, VK_IMAGE_VIEW_TYPE_2D, format, { VK_IMAGE_ASPECT_COLOR_BIT, 0, texture.mipLevelCount, 0, 1 }))
+                return result;
+            texture.size = texture.image.Allocation().size;
+
+            VkImageMemoryBarrier imageMemoryBarrier = {
+                .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                .srcAccessMask = 0,
+                .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+                .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image = texture.image,
+                .subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, texture.mipLevelCount, 0, 1 }
+            };
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+            VkBufferImageCopy region = {
+                .imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },
+                .imageExtent = { decoded.extent.width, decoded.extent.height, 1 }
+            };
+            vkCmdCopyBufferToImage(commandBuffer, decoded.stagingBuffer, texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+            // 逐级将上一级mip缩小一半blit到下一级, 每级在被读取前转为VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+            imageMemoryBarrier.subresourceRange.levelCount = 1;
+            int32_t width = decoded.extent.width, height = decoded.extent.height;
+            for (uint32_t i = 1; i < texture.mipLevelCount; i++) {
+                imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+                imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+                imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+                imageMemoryBarrier.subresourceRange.baseMipLevel = i - 1;
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                    0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+                VkImageBlit blit = {
+                    .srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, i - 1, 0, 1 },
+                    .srcOffsets = { {}, { width, height, 1 } },
+                    .dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, i, 0, 1 },
+                    .dstOffsets = { {}, { std::max(width / 2, 1), std::max(height / 2, 1), 1 } }
+                };
+                vkCmdBlitImage(commandBuffer,
+                    texture.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                    texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    1, &blit, VK_FILTER_LINEAR);
+                width = std::max(width / 2, 1);
+                height = std::max(height / 2, 1);
+            }
+
+            // 除最后一级外, 各级处于VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+            VkImageMemoryBarrier imageMemoryBarriers[2] = { imageMemoryBarrier, imageMemoryBarrier };
+            imageMemoryBarriers[0].srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            imageMemoryBarriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            imageMemoryBarriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            imageMemoryBarriers[0].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            imageMemoryBarriers[0].subresourceRange.baseMipLevel = 0;
+            imageMemoryBarriers[0].subresourceRange.levelCount = texture.mipLevelCount - 1;
+            imageMemoryBarriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            imageMemoryBarriers[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            imageMemoryBarriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            imageMemoryBarriers[1].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            imageMemoryBarriers[1].subresourceRange.baseMipLevel = texture.mipLevelCount - 1;
+            imageMemoryBarriers[1].subresourceRange.levelCount = 1;
+            uint32_t barrierCount = texture.mipLevelCount > 1 ? 2 : 1;
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                0, nullptr, 0, nullptr, barrierCount, imageMemoryBarriers + 2 - barrierCount);
+
+            // 暂存缓冲区在当前帧执行完毕后销毁
+            decoded.stagingBuffer.DeferDestroy();
+            texture.residency = residency_resident;
+            return VK_SUCCESS;
+        }
+        // 按最近最少使用的顺序驱逐驻留的贴图, 直至总大小不超出预算, 当前帧访问过的贴图不被驱逐
+        void Evict_Internal() {
+            uint64_t currentFrame = graphicsBase::Base().FrameNumber();
+            while (residentSize > residencyBudget) {
+                texture* pLeastRecentlyUsed = nullptr;
+                for (auto& i : textures)
+                    if (i.residency == residency_resident &&
+                        i.lastUsedFrame < currentFrame &&
+                        (!pLeastRecentlyUsed || i.lastUsedFrame < pLeastRecentlyUsed->lastUsedFrame))
+                        pLeastRecentlyUsed = &i;
+                if (!pLeastRecentlyUsed)
+                    return;
+                // 贴图可能仍被先前的帧所使用, 延迟到这些帧执行完毕后销毁
+                pLeastRecentlyUsed->imageView.DeferDestroy();
+                pLeastRecentlyUsed->image.DeferDestroy();
+                pLeastRecentlyUsed->residency = residency_evicted;
+                residentSize -= pLeastRecentlyUsed->size;
+            }
+        }
+    public:
+        textureStreamer() = default;
+        textureStreamer(VkDeviceSize residencyBudget, VkFormat format = defaultFormat) {
+            Create(residencyBudget, format);
+        }
+        textureStreamer(textureStreamer&&) = delete;
+        ~textureStreamer() {
+            jobSystem::Default().Wait(pendingDecodes);
+        }
+        //Getter
+        VkDeviceSize ResidentSize() const {
+            return residentSize;
+        }
+        VkDeviceSize ResidencyBudget() const {
+            return residencyBudget;
+        }
+        uint32_t TextureCount() const {
+            return uint32_t(textures.size());
+        }
+        residency Residency(uint32_t index) const {
+            return textures[index].residency;
+        }
+        // 返回贴图的image view并将其标记为在当前帧中被使用, 贴图未驻留时返回占位贴图, 被驱逐的贴图会被重新流送
+        VkImageView ImageView(uint32_t index) {
+            texture& texture = textures[index];
+            texture.lastUsedFrame = graphicsBase::Base().FrameNumber();
+            if (texture.residency == residency_evicted)
+                Enqueue_Internal(index);
+            return texture.residency == residency_resident ? texture.imageView : placeholder.imageView;
+        }
+        VkImageView PlaceholderImageView() const {
+            return placeholder.imageView;
+        }
+        //Non-const Function
+        void ResidencyBudget(VkDeviceSize residencyBudget) {
+            this->residencyBudget = residencyBudget;
+        }
+        // 每帧上传的数据量的上限, 以免大量贴图同时完成解码时造成卡顿, 每帧至少上传一张贴图
+        void UploadBudgetPerFrame(VkDeviceSize size) {
+            uploadBudgetPerFrame = size;
+        }
+        // 请求流送filepath所指的图像文件, 立即返回贴图的索引
+        uint32_t Request(const char* filepath) {
+            uint32_t index = uint32_t(textures.size());
+            textures.emplace_back().path = filepath;
+            Enqueue_Internal(index);
+            return index;
+        }
+        // 在渲染线程中每帧调用一次, 将已解码的贴图上传并生成mipmap, 然后驱逐超出预算的贴图
+        // 命令被录制在commandBuffer中, 须在采样这些贴图的命令前执行, commandBuffer所在的队列须支持图形操作
+        result_t Update(VkCommandBuffer commandBuffer) {
+            if (placeholderPixels) {
+                if (VkResult result = Upload_Internal(commandBuffer, placeholder, *placeholderPixels))
+                    return result;
+                placeholderPixels.reset();
+            }
+            VkDeviceSize uploadedSize = 0;
+            while (uploadedSize < uploadBudgetPerFrame) {
+                std::unique_lock lock(mutex);
+                if (decodedImages.empty())
+                    break;
+                decodedImage decoded = std::move(decodedImages.front());
+                decodedImages.pop_front();
+                lock.unlock();
+                texture& texture = textures[decoded.index];
+                if (!decoded.stagingBuffer) {
+                    texture.residency = residency_failed;
+                    continue;
+                }
+                if (VkResult result = Upload_Internal(commandBuffer, texture, decoded)) {
+                    texture.imageView.~imageView();
+                    texture.image.~image();
+                    texture.residency = residency_failed;
+                    return result;
+                }
+                residentSize += texture.size;
+                uploadedSize += decoded.stagingBuffer.Size();
+            }
+            Evict_Internal();
+            return VK_SUCCESS;
+        }
+        result_t Create(VkDeviceSize residencyBudget, VkFormat format = defaultFormat) {
+            this->residencyBudget = residencyBudget;
+            this->format = format;
+            // 格式不支持线性过滤的blit时不生成mipmap
+            VkFormatProperties formatProperties;
+            vkGetPhysicalDeviceFormatProperties(graphicsBase::Base().PhysicalDevice(), format, &formatProperties);
+            linearBlit =
+                formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_SRC_BIT &&
+                formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_DST_BIT &&
+                formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+            // 占位贴图为4x4的灰色棋盘格, 在首次Update(...)时上传
+            static constexpr uint32_t placeholderSize = 4;
+            placeholderPixels = std::make_unique<decodedImage>(decodedImage{ UINT32_MAX, { placeholderSize, placeholderSize } });
+            if (VkResult result = placeholderPixels->stagingBuffer.Create(placeholderSize * placeholderSize * 4, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+                return result;
+            auto pTexels = static_cast<uint32_t*>(placeholderPixels->stagingBuffer.MappedData());
+            if (!pTexels) {
+                outStream << std::format("[ textureStreamer ] ERROR\nThe staging buffer is not mapped!\n");
+                return VK_RESULT_MAX_ENUM;
+            }
+            for (uint32_t y = 0; y < placeholderSize; y++)
+                for (uint32_t x = 0; x < placeholderSize; x++)
+                    pTexels[y * placeholderSize + x] = (x + y) % 2 ? 0xff606060 : 0xff9f9f9f;
+            placeholderPixels->stagingBuffer.Flush();
+            return VK_SUCCESS;
+        }
+    };
+
+    // 渲染通道的中间附件（深度、多重采样、G-buffer等）, 尺寸随交换链图像尺寸变化, 通常在交换链的创建和销毁回调中调用Create(...)和Destroy()
+    // 用途含VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT的附件优先使用lazily allocated的内存, 在tile-based GPU上可能完全不占用显存
+    // 所在渲染通道的区间[firstPass, lastPass]不重叠的附件共用同一段内存, 共用内存的附件在每次使用前内容未定义, 须以VK_IMAGE_LAYOUT_UNDEFINED为初始布局
+    class attachmentPool {
+    public:
+        struct attachmentInfo {
+            VkFormat format = VK_FORMAT_UNDEFINED;
+            VkImageUsageFlags usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+            VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+            // 附件被使用的首个和最后一个渲染通道（或子通道）的序号, 默认与所有附件重叠, 即不共用内存
+            uint32_t firstPass = 0;
+            uint32_t lastPass = UINT32_MAX;
+            // 尺寸相对于Create(...)所指定尺寸的比例
+            float scale = 1.f;
+        };
+    private:
+        struct attachment {
+            attachmentInfo info;
+            VkImage image = VK_NULL_HANDLE;
+            vulkan::imageView imageView;
+            VkExtent2D extent = {};
+            VkMemoryRequirements memoryRequirements = {};
+            uint32_t slot = 0;
+        };
+        // 一段被一个或多个附件共用的内存
+        struct memorySlot {
+            bool transient;
+            uint32_t lastPass;
+            VkMemoryRequirements memoryRequirements;
+            memoryAllocator::allocation allocation;
+        };
+        std::vector<attachment> attachments;
+        std::vector<memorySlot> slots;
+        //--------------------
+        // 按首次使用的顺序为各附件分配内存槽位, 槽位中先前的附件已不再被使用且内存类型兼容时共用之
+        void AssignSlots_Internal() {
+            slots.clear();
+            std::vector<uint32_t> order(attachments.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::ranges::stable_sort(order, {}, [this](uint32_t i) { return attachments[i].info.firstPass; });
+            for (uint32_t i : order) {
+                auto& attachment = attachments[i];
+                bool transient = attachment.info.usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+                auto& requirements = attachment.memoryRequirements;
+                uint32_t slotIndex = 0;
+                for (; slotIndex < slots.size(); slotIndex++)
+                    if (slots[slotIndex].transient == transient &&
+                        slots[slotIndex].lastPass < attachment.info.firstPass &&
+                        slots[slotIndex].memoryRequirements.memoryTypeBits & requirements.memoryTypeBits)
+                        break;
+                if (slotIndex == slots.size())
+                    slots.push_back({ transient, attachment.info.lastPass, requirements });
+                else {
+                    auto& slot = slots[slotIndex];
+                    slot.lastPass = attachment.info.lastPass;
+                    slot.memoryRequirements.size = std::max(slot.memoryRequirements.size, requirements.size);
+                    slot.memoryRequirements.alignment = std::max(slot.memoryRequirements.alignment, requirements.alignment);
+                    slot.memoryRequirements.memoryTypeBits &= requirements.memoryTypeBits;
+                }
+                attachment.slot = slotIndex;
+            }
+        }
+    public:
+        attachmentPool() = default;
+        attachmentPool(attachmentPool&&) = delete;
+        ~attachmentPool() {
+            for (auto& i : attachments)
+                if (i.image)
+                    vkDestroyImage(graphicsBase::Base().Device(), i.image, nullptr),
+                    graphicsBase::Base().CountResource(resourceType_image, -1, -int64_t(i.memoryRequirements.size));
+            for (auto& i : slots)
+                memoryAllocator::Default().Free(i.allocation);
+            // 作为函数内的静态对象时, 可能在此之后才执行交换链的销毁回调
+            attachments.clear();
+            slots.clear();
+        }
+        //Getter
+        uint32_t AttachmentCount() const {
+            return uint32_t(attachments.size());
+        }
+        VkImage Image(uint32_t index) const {
+            return attachments[index].image;
+        }
+        VkImageView ImageView(uint32_t index) const {
+            return attachments[index].imageView;
+        }
+        VkExtent2D Extent(uint32_t index) const {
+            return attachments[index].extent;
+        }
+        const attachmentInfo& AttachmentInfo(uint32_t index) const {
+            return attachments[index].info;
+        }
+        // 实际分配的内存大小, 及不共用内存时所需的大小
+        VkDeviceSize MemorySize() const {
+            VkDeviceSize size = 0;
+            for (auto& i : slots)
+                size += i.memoryRequirements.size;
+            return size;
+        }
+        VkDeviceSize UnaliasedMemorySize() const {
+            VkDeviceSize size = 0;
+            for (auto& i : attachments)
+                size += i.memoryRequirements.size;
+            return size;
+        }
+        //Non-const Function
+        // 添加附件并返回其索引, 在下一次Create(...)时生效
+        uint32_t Add(const attachmentInfo& info) {
+            attachments.emplace_back().info = info;
+            return uint32_t(attachments.size() - 1);
+        }
+        // 以extent为基准尺寸创建所有附件, 先前创建的附件会被延迟销毁
+        result_t Create(VkExtent2D extent) {
+            Destroy();
+            VkDevice device = graphicsBase::Base().Device();
+            for (auto& i : attachments) {
+                i.extent = {
+                    std::max(uint32_t(extent.width * i.info.scale), 1u),
+                    std::max(uint32_t(extent.height * i.info.scale), 1u)
+                };
+                VkImageCreateInfo imageCreateInfo = {
+                    .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+                    .imageType = VK_IMAGE_TYPE_2D,
+                    .format = i.info.format,
+                    .extent = { i.extent.width, i.extent.height, 1 },
+                    .mipLevels = 1,
+                    .arrayLayers = 1,
+                    .samples = i.info.samples,
+                    .tiling = VK_IMAGE_TILING_OPTIMAL,
+                    .usage = i.info.usage
+                };
+                if (VkResult result = vkCreateImage(device, &imageCreateInfo, nullptr, &i.image)) {
+                    outStream << std::format("[ attachmentPool ] ERROR\nFailed to create an attachment!\nError code: {}\n", int32_t(result));
+                    return result;
+                }
+                vkGetImageMemoryRequirements(device, i.image, &i.memoryRequirements);
+                graphicsBase::Base().CountResource(resourceType_image, 1, i.memoryRequirements.size);
+            }
+            AssignSlots_Internal();
+            for (auto& i : slots)
+                if (VkResult result = memoryAllocator::Default().Allocate(i.memoryRequirements,
+                    // 没有惰性分配的内存类型时, 放宽要求后仍须为device local
+                    i.transient ? VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, true, i.allocation))
+                    return result;
+            for (auto& i : attachments) {
+                auto& allocation = slots[i.slot].allocation;
+                if (VkResult result = vkBindImageMemory(device, i.image, allocation.memory, allocation.offset)) {
+                    outStream << std::format("[ attachmentPool ] ERROR\nFailed to bind the memory to an attachment!\nError code: {}\n", int32_t(result));
+                    return result;
+                }
+                if (VkResult result = i.imageView.Create(i.image, VK_IMAGE_VIEW_TYPE_2D, i.info.format, { AspectMask(i.info.format), 0, 1, 0, 1 }))
+                    return result;
+            }
+            return VK_SUCCESS;
+        }
+        // 附件可能仍被先前的帧所使用, 延迟到这些帧执行完毕后销毁
+        void Destroy() {
+            std::vector<VkImage> images;
+            std::vector<memoryAllocator::allocation> allocations;
+            int64_t size = 0;
+            for (auto& i : attachments) {
+                i.imageView.DeferDestroy();
+                if (i.image)
+                    images.push_back(i.image),
+                    size += i.memoryRequirements.size;
+                i.image = VK_NULL_HANDLE;
+            }
+            for (auto& i : slots)
+                if (i.allocation)
+                    allocations.push_back(i.allocation);
+            slots.clear();
+            if (images.empty() && allocations.empty())
+                return;
+            graphicsBase::Base().DeferDestruction([device = graphicsBase::Base().Device(), images = std::move(images), allocations = std::move(allocations), size]() mutable {
+                for (auto& i : images)
+                    vkDestroyImage(device, i, nullptr);
+                graphicsBase::Base().CountResource(resourceType_image, -int64_t(images.size()), -size);
+                for (auto& i : allocations)
+                    memoryAllocator::Default().Free(i);
+            });
+        }
+        // 销毁并移除所有附件, 此后可重新Add(...)
+        void Clear() {
+            Destroy();
+            attachments.clear();
+        }
+        //Static Function
+        // 由格式推断图像的aspect
+        static VkImageAspectFlags AspectMask(VkFormat format) {
+            switch (format) {
+            case VK_FORMAT_D16_UNORM:
+            case VK_FORMAT_X8_D24_UNORM_PACK32:
+            case VK_FORMAT_D32_SFLOAT:
+                return VK_IMAGE_ASPECT_DEPTH_BIT;
+            case VK_FORMAT_S8_UINT:
+                return VK_IMAGE_ASPECT_STENCIL_BIT;
+            case VK_FORMAT_D16_UNORM_S8_UINT:
+            case VK_FORMAT_D24_UNORM_S8_UINT:
+            case VK_FORMAT_D32_SFLOAT_S8_UINT:
+                return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+            default:
+                return VK_IMAGE_ASPECT_COLOR_BIT;
+            }
+        }
+    };
+
+    // 逐帧线性分配命令缓冲区的瞬态命令池, 命令缓冲区不单独重置, 在使用它们的帧执行完毕后以Reset(...)整体重置, 然后从头依次重新取用
+    // 命令池以VK_COMMAND_POOL_CREATE_TRANSIENT_BIT创建, 不带VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, 驱动无需为逐个重置而维护各命令缓冲区的内存
+    class linearCommandPool {
+        vulkan::commandPool commandPool;
+        // 下标为VkCommandBufferLevel, 已分配的一级和二级命令缓冲区及本帧中已取用的数量
+        std::vector<vulkan::commandBuffer> commandBuffers[2];
+        uint32_t usedCounts[2] = {};
+    public:
+        linearCommandPool() = default;
+        linearCommandPool(uint32_t queueFamilyIndex) {
+            Create(queueFamilyIndex);
+        }
+        linearCommandPool(linearCommandPool&&) = default;
+        //Getter
+        const vulkan::commandPool& CommandPool() const {
+            return commandPool;
+        }
+        operator VkCommandPool() const {
+            return commandPool;
+        }
+        uint32_t UsedCount(VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY) const {
+            return usedCounts[level];
+        }
+        uint32_t AllocatedCount(VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY) const {
+            return uint32_t(commandBuffers[level].size());
+        }
+        //Non-const Function
+        // 取得一个处于初始状态的命令缓冲区, 不足时分配, 每次分配的数量与已分配的数量相同（至少4个）, 失败时返回nullptr
+        // 返回的指针在下一次调用Next(...)前有效, 须要保留时存其handle
+        const vulkan::commandBuffer* Next(VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY) {
+            auto& buffers = commandBuffers[level];
+            if (usedCounts[level] == buffers.size()) {
+                size_t oldCount = buffers.size();
+                buffers.resize(oldCount + std::max(oldCount, size_t(4)));
+                if (commandPool.AllocateBuffers({ buffers.data() + oldCount, buffers.size() - oldCount }, level)) {
+                    buffers.resize(oldCount);
+                    return nullptr;
+                }
+            }
+            return &buffers[usedCounts[level]++];
+        }
+        // 重置整个命令池, 先前取得的命令缓冲区均回到初始状态并可被再次取得, 调用前须确保它们已执行完毕
+        // releaseResources为true时将命令池的内存归还给系统, 适用于某帧录制的命令量远超平常之后
+        result_t Reset(bool releaseResources = false) {
+            usedCounts[0] = usedCounts[1] = 0;
+            return commandPool.Reset(releaseResources ? VK_COMMAND_POOL_RESET_RELEASE_RESOURCES_BIT : 0);
+        }
+        result_t Create(uint32_t queueFamilyIndex) {
+            return commandPool.Create(queueFamilyIndex, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+        }
+        // 命令缓冲区可能仍在执行, 延迟到当前帧执行完毕后销毁命令池
+        void DeferDestroy() {
+            commandPool.DeferDestroy();
+            commandBuffers[0].clear();
+            commandBuffers[1].clear();
+            usedCounts[0] = usedCounts[1] = 0;
+        }
+    };
+
+    // 以jobSystem::Default()的任务并行录制二级命令缓冲区, 每个线程在每个帧槽位各有一个命令池, 各线程只使用自己的命令池, 录制时无需加锁
+    // 工作线程以外的线程共用线程索引0的命令池, 因而同一时间只能有一个非工作线程调用Record(...)
+    // 用法: 以VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS开始渲染通道（见renderPass::CmdBegin(...)）后调用Record(...), 然后结束渲染通道
+    class parallelRecorder {
+    public:
+        // 录制[begin, end)范围内的绘制, 二级命令缓冲区不继承动态状态, 须在其中重新设置视口、裁剪等动态状态及绑定管线和描述符
+        using recordFunction = std::function<void(VkCommandBuffer commandBuffer, uint32_t begin, uint32_t end)>;
+    private:
+        uint32_t threadCount = 0;
+        uint32_t frameSlotCount = 0;
+        uint32_t currentFrameSlot = 0;
+        // 各线程在各帧槽位中所用的命令池, 同一帧中多次调用Record(...)时依次取用其中的二级命令缓冲区
+        // 下标为帧槽位索引 * threadCount + 线程索引, 线程索引见jobSystem::CurrentThreadIndex()
+        std::vector<linearCommandPool> commandPools;
+        // 下标为分段索引, 保持绘制的顺序
+        std::vector<VkCommandBuffer> secondaryCommandBuffers;
+        //--------------------
+        // 从当前帧槽位中当前线程的命令池取得一个二级命令缓冲区
+        VkCommandBuffer NextCommandBuffer_Internal() {
+            auto pCommandBuffer = commandPools[currentFrameSlot * threadCount + jobSystem::Default().CurrentThreadIndex()].Next(VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+            return pCommandBuffer ? VkCommandBuffer(*pCommandBuffer) : VK_NULL_HANDLE;
+        }
+    public:
+        parallelRecorder() = default;
+        parallelRecorder(uint32_t frameSlotCount, uint32_t queueFamilyIndex = graphicsBase::Base().QueueFamilyIndex_Graphics()) {
+            Create(frameSlotCount, queueFamilyIndex);
+        }
+        parallelRecorder(parallelRecorder&&) = delete;
+        //Getter
+        uint32_t ThreadCount() const {
+            return threadCount;
+        }
+        //Non-const Function
+        // 开始在frameSlot对应的命令池中录制并重置这些命令池, 调用前须确保该帧槽位先前的命令已执行完毕（如已等待frameContext中对应槽位的栅栏）
+        result_t BeginFrame(uint32_t frameSlot) {
+            currentFrameSlot = frameSlot % frameSlotCount;
+            for (uint32_t i = 0; i < threadCount; i++)
+                if (VkResult result = commandPools[currentFrameSlot * threadCount + i].Reset())
+                    return result;
+            return VK_SUCCESS;
+        }
+        // 将[0, drawCount)均分为至多threadCount段, 各段作为一个任务录制到二级命令缓冲区, 然后在primaryCommandBuffer中按顺序执行这些二级命令缓冲区
+        // inheritanceInfo须指定渲染通道和子通道, 指定帧缓冲可能使驱动生成更优的命令
+        result_t Record(VkCommandBuffer primaryCommandBuffer, VkCommandBufferInheritanceInfo inheritanceInfo, uint32_t drawCount, const recordFunction& record) {
+            inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+            uint32_t chunkSize = (drawCount + threadCount - 1) / threadCount;
+            std::atomic<VkResult> firstError = VK_SUCCESS;
+            secondaryCommandBuffers.assign(threadCount, VK_NULL_HANDLE);
+            auto recordChunk = [&](uint32_t chunkIndex) {
+                uint32_t begin = std::min(chunkIndex * chunkSize, drawCount);
+                uint32_t end = std::min(begin + chunkSize, drawCount);
+                if (begin == end)
+                    return;
+                VkCommandBuffer commandBuffer = NextCommandBuffer_Internal();
+                VkCommandBufferBeginInfo beginInfo = {
+                    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                    .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+                    .pInheritanceInfo = &inheritanceInfo
+                };
+                VkResult result = commandBuffer ? vkBeginCommandBuffer(commandBuffer, &beginInfo) : VK_RESULT_MAX_ENUM;
+                if (!result) {
+                    record(commandBuffer, begin, end);
+                    result = vkEndCommandBuffer(commandBuffer);
+                }
+                if (result) {
+                    VkResult expected = VK_SUCCESS;
+                    firstError.compare_exchange_strong(expected, result);
+                    return;
+                }
+                secondaryCommandBuffers[chunkIndex] = commandBuffer;
+                };
+            jobSystem::counter done;
+            for (uint32_t i = 1; i < threadCount && i * chunkSize < drawCount; i++)
+                jobSystem::Default().Run([&recordChunk, i] { recordChunk(i); }, &done);
+            // 调用Record(...)的线程亦参与录制, 并在等待时执行其他任务
+            recordChunk(0);
+            jobSystem::Default().Wait(done);
+            if (VkResult result = firstError) {
+                outStream << std::format("[ parallelRecorder ] ERROR\nFailed to record a secondary command buffer!\nError code: {}\n", int32_t(result));
+                return result;
+            }
+            std::erase(secondaryCommandBuffers, VkCommandBuffer(VK_NULL_HANDLE));
+            if (secondaryCommandBuffers.size())
+                vkCmdExecuteCommands(primaryCommandBuffer, uint32_t(secondaryCommandBuffers.size()), secondaryCommandBuffers.data());
+            return VK_SUCCESS;
+        }
+        // 线程数为jobSystem::Default().ThreadCount(), 即工作线程数加1
+        result_t Create(uint32_t frameSlotCount, uint32_t queueFamilyIndex = graphicsBase::Base().QueueFamilyIndex_Graphics()) {
+            threadCount = jobSystem::Default().ThreadCount();
+            this->frameSlotCount = frameSlotCount;
+            commandPools = std::vector<linearCommandPool>(size_t(frameSlotCount) * threadCount);
+            for (auto& i : commandPools)
+                if (VkResult result = i.Create(queueFamilyIndex))
+                    return result;
+            return VK_SUCCESS;
+        }
+    };
+
+    // 屏障批处理器, 收集全局内存屏障、缓冲区屏障和图像屏障, Flush(...)时以一次vkCmdPipelineBarrier2（Vulkan1.3或VK_KHR_synchronization2可用时）或vkCmdPipelineBarrier录制
+    // 同一图像的同一子资源范围（或同一缓冲区的同一范围）的多次转换合并为一次: 旧布局取首次的, 新布局取末次的, 源和目标的阶段及访问均取并集
+    // 回退到vkCmdPipelineBarrier时, 各屏障的阶段取并集
+    // validate为true时（默认在Debug构建中）, 对冗余的屏障和过于宽泛的阶段输出警告, 每种警告仅输出一次
+    class barrierBatcher {
+        std::vector<VkMemoryBarrier2> memoryBarriers;
+        std::vector<VkBufferMemoryBarrier2> bufferMemoryBarriers;
+        std::vector<VkImageMemoryBarrier2> imageMemoryBarriers;
+        bool validate = ENABLE_DEBUG_MESSENGER;
+        uint32_t issuedWarnings = 0;
+        enum warning {
+            warning_readAfterRead = 1,
+            warning_broadStage = 2,
+            warning_ineffectiveAccess = 4,
+            warning_layoutMismatch = 8
+        };
+        static constexpr VkAccessFlags writeAccessMask =
+            VK_ACCESS_SHADER_WRITE_BIT |
+            VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+            VK_ACCESS_TRANSFER_WRITE_BIT |
+            VK_ACCESS_HOST_WRITE_BIT |
+            VK_ACCESS_MEMORY_WRITE_BIT;
+        //--------------------
+        void Warn_Internal(warning kind, const char* message) {
+            if (issuedWarnings & kind)
+                return;
+            issuedWarnings |= kind;
+            outStream << std::format("[ barrierBatcher ] WARNING\n{}\n", message);
+        }
+        void Validate_Internal(VkPipelineStageFlags srcStages, VkAccessFlags srcAccess, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess, bool transition) {
+            if (!validate)
+                return;
+            // 无布局转换和所有权转移时, 读后读之间无需屏障
+            if (!transition && dstAccess && !(srcAccess & writeAccessMask) && !(dstAccess & writeAccessMask))
+                Warn_Internal(warning_readAfterRead, "A read-after-read barrier without layout transition is redundant!");
+            if ((srcStages | dstStages) & (VK_PIPELINE_STAGE_ALL_COMMANDS_BIT | VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT))
+                Warn_Internal(warning_broadStage, "ALL_COMMANDS or ALL_GRAPHICS stage mask used, consider narrowing it to the stages that actually access the resource!");
+            if ((srcStages == VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT && srcAccess) ||
+                (dstStages == VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT && dstAccess))
+                Warn_Internal(warning_ineffectiveAccess, "Access mask has no effect with TOP_OF_PIPE source or BOTTOM_OF_PIPE destination stage!");
+        }
+        static bool SameRange(const VkImageSubresourceRange& a, const VkImageSubresourceRange& b) {
+            return a.aspectMask == b.aspectMask &&
+                a.baseMipLevel == b.baseMipLevel && a.levelCount == b.levelCount &&
+                a.baseArrayLayer == b.baseArrayLayer && a.layerCount == b.layerCount;
+        }
+    public:
+        barrierBatcher() = default;
+        barrierBatcher(bool validate) :validate(validate) {}
+        //Getter
+        uint32_t BarrierCount() const {
+            return uint32_t(memoryBarriers.size() + bufferMemoryBarriers.size() + imageMemoryBarriers.size());
+        }
+        bool Empty() const {
+            return !BarrierCount();
+        }
+        //Non-const Function
+        // 阶段和访问均相同的全局内存屏障合并为一个
+        barrierBatcher& Global(VkPipelineStageFlags srcStages, VkAccessFlags srcAccess, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess) {
+            Validate_Internal(srcStages, srcAccess, dstStages, dstAccess, false);
+            for (auto& i : memoryBarriers)
+                if (i.srcStageMask == srcStages && i.dstStageMask == dstStages &&
+                    i.srcAccessMask == srcAccess && i.dstAccessMask == dstAccess)
+                    return *this;
+            memoryBarriers.push_back({
+                .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+                .srcStageMask = srcStages,
+                .srcAccessMask = srcAccess,
+                .dstStageMask = dstStages,
+                .dstAccessMask = dstAccess
+            });
+            return *this;
+        }
+        barrierBatcher& Buffer(VkBuffer buffer, VkPipelineStageFlags srcStages, VkAccessFlags srcAccess, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess,
+            VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE,
+            uint32_t srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED, uint32_t dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED) {
+            Validate_Internal(srcStages, srcAccess, dstStages, dstAccess, srcQueueFamilyIndex != dstQueueFamilyIndex);
+            for (auto& i : bufferMemoryBarriers)
+                if (i.buffer == buffer && i.offset == offset && i.size == size &&
+                    i.srcQueueFamilyIndex == srcQueueFamilyIndex && i.dstQueueFamilyIndex == dstQueueFamilyIndex) {
+                    // 源和目标作用域均取并集, 以免后一个屏障要使之可用的写入不被同步
+                    i.srcStageMask |= srcStages;
+                    i.srcAccessMask |= srcAccess;
+                    i.dstStageMask |= dstStages;
+                    i.dstAccessMask |= dstAccess;
+                    return *this;
+                }
+            bufferMemoryBarriers.push_back({
+                .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+                .srcStageMask = srcStages,
+                .srcAccessMask = srcAccess,
+                .dstStageMask = dstStages,
+                .dstAccessMask = dstAccess,
+                .srcQueueFamilyIndex = srcQueueFamilyIndex,
+                .dstQueueFamilyIndex = dstQueueFamilyIndex,
+                .buffer = buffer,
+                .offset = offset,
+                .size = size
+            });
+            return *this;
+        }
+        barrierBatcher& Image(VkImage image, const VkImageSubresourceRange& subresourceRange,
+            VkPipelineStageFlags srcStages, VkAccessFlags srcAccess, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess,
+            VkImageLayout oldLayout, VkImageLayout newLayout,
+            uint32_t srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED, uint32_t dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED) {
+            Validate_Internal(srcStages, srcAccess, dstStages, dstAccess, oldLayout != newLayout || srcQueueFamilyIndex != dstQueueFamilyIndex);
+            for (auto& i : imageMemoryBarriers)
+                if (i.image == image && SameRange(i.subresourceRange, subresourceRange) &&
+                    i.srcQueueFamilyIndex == srcQueueFamilyIndex && i.dstQueueFamilyIndex == dstQueueFamilyIndex) {
+                    // 中间布局不会被使用, 直接从首次的旧布局转换到末次的新布局
+                    if (validate && oldLayout != i.newLayout && oldLayout != VK_IMAGE_LAYOUT_UNDEFINED)
+                        Warn_Internal(warning_layoutMismatch, "Merged image barriers disagree on the intermediate layout!");
+                    i.newLayout = newLayout;
+                    i.srcStageMask |= srcStages;
+                    i.srcAccessMask |= srcAccess;
+                    i.dstStageMask |= dstStages;
+                    i.dstAccessMask |= dstAccess;
+                    return *this;
+                }
+            imageMemoryBarriers.push_back({
+                .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+                .srcStageMask = srcStages,
+                .srcAccessMask = srcAccess,
+                .dstStageMask = dstStages,
+                .dstAccessMask = dstAccess,
+                .oldLayout = oldLayout,
+                .newLayout = newLayout,
+                .srcQueueFamilyIndex = srcQueueFamilyIndex,
+                .dstQueueFamilyIndex = dstQueueFamilyIndex,
+                .image = image,
+                .subresourceRange = subresourceRange
+            });
+            return *this;
+        }
+        // 录制所有收集到的屏障并清空, 无屏障时不录制任何命令
+        void Flush(VkCommandBuffer commandBuffer) {
+            if (Empty())
+                return;
+            if (auto CmdPipelineBarrier2 = graphicsBase::Base().CmdPipelineBarrier2()) {
+                VkDependencyInfo dependencyInfo = {
+                    .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+                    .memoryBarrierCount = uint32_t(memoryBarriers.size()),
+                    .pMemoryBarriers = memoryBarriers.data(),
+                    .bufferMemoryBarrierCount = uint32_t(bufferMemoryBarriers.size()),
+                    .pBufferMemoryBarriers = bufferMemoryBarriers.data(),
+                    .imageMemoryBarrierCount = uint32_t(imageMemoryBarriers.size()),
+                    .pImageMemoryBarriers = imageMemoryBarriers.data()
+                };
+                CmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+            }
+            else {
+                // 添加时的阶段和访问均为VkPipelineStageFlags和VkAccessFlags, 截断为32位不丢失信息
+                VkPipelineStageFlags srcStages = 0, dstStages = 0;
+                std::vector<VkMemoryBarrier> memoryBarriers_legacy;
+                std::vector<VkBufferMemoryBarrier> bufferMemoryBarriers_legacy;
+                std::vector<VkImageMemoryBarrier> imageMemoryBarriers_legacy;
+                memoryBarriers_legacy.reserve(memoryBarriers.size());
+                bufferMemoryBarriers_legacy.reserve(bufferMemoryBarriers.size());
+                imageMemoryBarriers_legacy.reserve(imageMemoryBarriers.size());
+                for (auto& i : memoryBarriers)
+                    srcStages |= VkPipelineStageFlags(i.srcStageMask),
+                    dstStages |= VkPipelineStageFlags(i.dstStageMask),
+                    memoryBarriers_legacy.push_back({
+                        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                        .srcAccessMask = VkAccessFlags(i.srcAccessMask),
+                        .dstAccessMask = VkAccessFlags(i.dstAccessMask)
+                    });
+                for (auto& i : bufferMemoryBarriers)
+                    srcStages |= VkPipelineStageFlags(i.srcStageMask),
+                    dstStages |= VkPipelineStageFlags(i.dstStageMask),
+                    bufferMemoryBarriers_legacy.push_back({
+                        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                        .srcAccessMask = VkAccessFlags(i.srcAccessMask),
+                        .dstAccessMask = VkAccessFlags(i.dstAccessMask),
+                        .srcQueueFamilyIndex = i.srcQueueFamilyIndex,
+                        .dstQueueFamilyIndex = i.dstQueueFamilyIndex,
+                        .buffer = i.buffer,
+                        .offset = i.offset,
+                        .size = i.size
+                    });
+                for (auto& i : imageMemoryBarriers)
+                    srcStages |= VkPipelineStageFlags(i.srcStageMask),
+                    dstStages |= VkPipelineStageFlags(i.dstStageMask),
+                    imageMemoryBarriers_legacy.push_back({
+                        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                        .srcAccessMask = VkAccessFlags(i.srcAccessMask),
+                        .dstAccessMask = VkAccessFlags(i.dstAccessMask),
+                        .oldLayout = i.oldLayout,
+                        .newLayout = i.newLayout,
+                        .srcQueueFamilyIndex = i.srcQueueFamilyIndex,
+                        .dstQueueFamilyIndex = i.dstQueueFamilyIndex,
+                        .image = i.image,
+                        .subresourceRange = i.subresourceRange
+                    });
+                vkCmdPipelineBarrier(commandBuffer,
+                    srcStages ? srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                    dstStages ? dstStages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                    uint32_t(memoryBarriers_legacy.size()), memoryBarriers_legacy.data(),
+                    uint32_t(bufferMemoryBarriers_legacy.size()), bufferMemoryBarriers_legacy.data(),
+                    uint32_t(imageMemoryBarriers_legacy.size()), imageMemoryBarriers_legacy.data());
+            }
+            Clear();
+        }
+        void Clear() {
+            memoryBarriers.clear();
+            bufferMemoryBarriers.clear();
+            imageMemoryBarriers.clear();
+        }
+        void Validate(bool validate) {
+            this->validate = validate;
+        }
+    };
+
+    // 帧渲染图, 各pass声明其所读写的资源及访问方式, Compile(...)据此:
+    // 剔除输出未被使用的pass; 推断渲染图所创建的图像的用途, 生命周期不重叠的图像共用内存（见attachmentPool）;
+    // 计算各pass前所需的屏障和布局转换, 同一pass前的屏障由barrierBatcher合并为一次录制; 为有附件的pass创建渲染通道, 附件的storeOp取决于其内容之后是否被读取;
+    // 存在独立的计算队列族时, 将标记为queue_asyncCompute的pass分配到计算队列, 跨队列的依赖以信号量和队列族所有权转移表达
+    // 用法: 导入交换链图像等外部资源并创建内部图像, 添加pass并声明访问, 然后调用Compile(...); 每帧以SetImportedImage(...)更新外部图像, 然后调用Execute(...)
+    // 同一pass中每个资源只可被声明一次; pass的录制函数中无需录制屏障, 亦无需开始或结束渲染通道
+    // 呈现队列族与图形队列族不同时, 交换链图像的所有权转移仍须由使用者处理（见graphicsBase::CmdTransferImageOwnership(...)）
+    class renderGraph {
+    public:
+        enum queueType {
+            queue_graphics,
+            queue_asyncCompute  // 无独立的计算队列族, 或pass中含计算队列不支持的访问时, 在图形队列中执行
+        };
+        enum accessType {
+            access_colorAttachment,
+            access_depthStencilAttachment,
+            access_depthStencilReadOnly,
+            access_sampledGraphics,
+            access_sampledCompute,
+            access_storageReadGraphics,
+            access_storageWriteGraphics,
+            access_storageReadCompute,
+            access_storageWriteCompute,
+            access_uniformGraphics,
+            access_uniformCompute,
+            access_vertexBuffer,
+            access_indexBuffer,
+            access_indirectBuffer,
+            access_transferSrc,
+            access_transferDst,
+            accessTypeCount
+        };
+        class pass {
+            friend class renderGraph;
+            struct resourceAccess {
+                uint32_t resource;
+                accessType type;
+                // 为true时不保留资源原有的内容, 即以VK_ATTACHMENT_LOAD_OP_CLEAR或VK_ATTACHMENT_LOAD_OP_DONT_CARE使用的附件
+                bool discard;
+            };
+            struct attachment {
+                uint32_t access = UINT32_MAX;
+                VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+                VkClearValue clearValue = {};
+            };
+            std::string name;
+            uint32_t index;
+            renderGraph::queueType queue;
+            bool sideEffect = false;
+            std::vector<resourceAccess> accesses;
+            std::vector<attachment> colorAttachments;
+            attachment depthStencilAttachment;
+            std::function<void(VkCommandBuffer)> execute;
+            //--------------------
+            pass(const char* name, uint32_t index, renderGraph::queueType queue) :name(name), index(index), queue(queue) {}
+        public:
+            //Getter
+            const std::string& Name() const {
+                return name;
+            }
+            uint32_t Index() const {
+                return index;
+            }
+            //Non-const Function
+            // 作为颜色附件写入, 附件按调用的顺序对应片段着色器中的location
+            pass& Color(uint32_t image, VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE, VkClearColorValue clearColor = {}) {
+                colorAttachments.push_back({ uint32_t(accesses.size()), loadOp, { .color = clearColor } });
+                accesses.push_back({ image, access_colorAttachment, loadOp != VK_ATTACHMENT_LOAD_OP_LOAD });
+                return *this;
+            }
+            pass& DepthStencil(uint32_t image, VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR, VkClearDepthStencilValue clearValue = { 1.f, 0 }) {
+                depthStencilAttachment = { uint32_t(accesses.size()), loadOp, { .depthStencil = clearValue } };
+                accesses.push_back({ image, access_depthStencilAttachment, loadOp != VK_ATTACHMENT_LOAD_OP_LOAD });
+                return *this;
+            }
+            // 只作深度测试而不写入的深度模板附件
+            pass& DepthStencilReadOnly(uint32_t image) {
+                depthStencilAttachment = { uint32_t(accesses.size()), VK_ATTACHMENT_LOAD_OP_LOAD };
+                accesses.push_back({ image, access_depthStencilReadOnly, false });
+                return *this;
+            }
+            // 以附件以外的方式访问资源
+            pass& Access(uint32_t resource, accessType type) {
+                accesses.push_back({ resource, type, false });
+                return *this;
+            }
+            // 录制函数, 有附件时在渲染通道内被调用
+            pass& Execute(std::function<void(VkCommandBuffer)> function) {
+                execute = std::move(function);
+                return *this;
+            }
+            // 使该pass不被剔除, 用于有渲染图以外的副作用的pass（如写入查询池）
+            pass& SideEffect() {
+                sideEffect = true;
+                return *this;
+            }
+        };
+    private:
+        struct accessInfo {
+            VkPipelineStageFlags stage;
+            VkAccessFlags access;
+            VkImageLayout layout;
+            VkImageUsageFlags usage;
+            bool write;
+        };
+        static constexpr VkPipelineStageFlags graphicsShaderStages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        static constexpr VkPipelineStageFlags depthTestStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        // 计算队列支持的阶段, 只访问这些阶段的pass才可在计算队列中执行
+        static constexpr VkPipelineStageFlags computeQueueStages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+        // 下标为accessType
+        static constexpr accessInfo accessInfos[accessTypeCount] = {
+            { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, true },
+            { depthTestStages, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, true },
+            { depthTestStages, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, false },
+            { graphicsShaderStages, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, false },
+            { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, false },
+            { graphicsShaderStages, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, false },
+            { graphicsShaderStages, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, true },
+            { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, false },
+            { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, true },
+            { graphicsShaderStages, VK_ACCESS_UNIFORM_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, 0, false },
+            { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_UNIFORM_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, 0, false },
+            { VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, 0, false },
+            { VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, 0, false },
+            { VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, 0, false },
+            { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT, false },
+            { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT, true }
+        };
+        struct resource {
+            std::string name;
+            bool isImage = true;
+            bool imported = false;
+            // 为true时其内容在帧末须被保留, 不因无pass读取而被剔除
+            bool output = false;
+            // 图像, 外部图像的尺寸与Compile(...)所指定的尺寸相同
+            VkFormat format = VK_FORMAT_UNDEFINED;
+            VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+            float scale = 1.f;
+            VkImage image = VK_NULL_HANDLE;
+            VkImageView imageView = VK_NULL_HANDLE;
+            VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            VkPipelineStageFlags initialStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            // 缓冲区, 只可导入
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceSize size = VK_WHOLE_SIZE;
+            // 内部图像在attachments中的索引, 由Compile(...)确定, 未被使用的图像为UINT32_MAX
+            uint32_t attachmentIndex = UINT32_MAX;
+        };
+        // Compile(...)时模拟执行所用的资源状态
+        struct resourceState {
+            VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            // 最近一次写入（或布局转换）的阶段及访问, 及此后已与之同步的读取的阶段及访问
+            VkPipelineStageFlags writeStages = 0;
+            VkAccessFlags writeAccess = 0;
+            VkPipelineStageFlags readStages = 0;
+            VkAccessFlags readAccess = 0;
+            renderGraph::queueType queue = queue_graphics;
+            // 最近一次访问该资源的批次, 在帧开始时视作属于批次0
+            uint32_t batch = 0;
+            // 内容是否有效, 无效时以VK_IMAGE_LAYOUT_UNDEFINED为旧布局且不转移所有权
+            bool valid = false;
+            // 最近一次作为附件写入该资源的pass及附件的序号, 其storeOp在内容之后被读取时为VK_ATTACHMENT_STORE_OP_STORE
+            uint32_t lastAttachmentWriter = UINT32_MAX;
+            uint32_t lastAttachmentSlot = 0;
+        };
+        struct barrier {
+            uint32_t resource;
+            VkAccessFlags srcAccess;
+            VkAccessFlags dstAccess;
+            VkImageLayout oldLayout;
+            VkImageLayout newLayout;
+            uint32_t srcQueueFamilyIndex;
+            uint32_t dstQueueFamilyIndex;
+            // 各屏障各自的阶段, 由AddBarrier_Internal(...)填写
+            VkPipelineStageFlags srcStages = 0;
+            VkPipelineStageFlags dstStages = 0;
+        };
+        // 经barrierBatcher一次录制的屏障, 可用synchronization2时各屏障保留各自的阶段, 否则阶段取并集（为0时录制为TOP_OF_PIPE或BOTTOM_OF_PIPE）
+        struct barrierBatch {
+            std::vector<barrier> barriers;
+        };
+        struct compiledPass {
+            uint32_t pass;
+            uint32_t batch = 0;
+            // 在该pass前录制的屏障
+            barrierBatch barriers;
+            // 有附件时所用的渲染通道, 附件依次为各颜色附件和深度模板附件
+            vulkan::renderPass renderPass;
+            std::vector<VkAttachmentStoreOp> storeOps;
+            std::vector<VkClearValue> clearValues;
+            VkExtent2D extent = {};
+            // 以附件的image view为键缓存的帧缓冲, 外部图像的image view每帧可能不同
+            std::deque<std::pair<std::vector<VkImageView>, vulkan::framebuffer>> framebuffers;
+        };
+        // 提交到同一队列的连续的pass
+        struct batch {
+            renderGraph::queueType queue;
+            std::vector<uint32_t> compiledPasses;
+            // 所等待的其他队列的批次及等待的阶段
+            std::vector<std::pair<uint32_t, VkPipelineStageFlags>> waits;
+            // 是否被其他队列的批次等待
+            bool signal = false;
+            // 在批次末尾录制的屏障, 用于释放所有权及转换到外部图像的最终布局
+            barrierBatch releases;
+        };
+        // 某个队列上一次等待的另一队列的批次, 及该等待所在的批次和在waits中的序号, 用于合并等待
+        struct lastWait {
+            uint32_t srcBatch = UINT32_MAX;
+            uint32_t batch = 0;
+            uint32_t entry = 0;
+        };
+        static constexpr uint32_t maxFramebufferCount = 8;
+        std::deque<pass> passes;
+        std::vector<resource> resources;
+        attachmentPool attachments;
+        // 外部资源的初始阶段可能为ALL_COMMANDS, 不对其输出警告
+        barrierBatcher batcher{ false };
+        VkExtent2D extent = {};
+        uint32_t frameSlotCount = 0;
+        // 以下由Compile(...)生成
+        std::vector<uint32_t> compiledIndices;
+        std::vector<compiledPass> compiledPasses;
+        std::vector<batch> batches;
+        lastWait lastWaits[2];
+        // 下标为帧槽位索引 * 2 + queueType
+        std::vector<linearCommandPool> commandPools;
+        // 下标为帧槽位索引 * 批次数 + 批次索引
+        std::vector<vulkan::semaphore> semaphores;
+        //--------------------
+        static uint32_t QueueFamilyIndex_Internal(queueType queue) {
+            return queue == queue_graphics ?
+                graphicsBase::Base().QueueFamilyIndex_Graphics() :
+                graphicsBase::Base().QueueFamilyIndex_Compute();
+        }
+        static void AddBarrier_Internal(barrierBatch& barriers, VkPipelineStageFlags srcStages, VkPipelineStageFlags dstStages, const barrier& value) {
+            barriers.barriers.push_back(value);
+            barriers.barriers.back().srcStages = srcStages;
+            barriers.barriers.back().dstStages = dstStages;
+        }
+        // 使批次waitingBatch在stage阶段等待批次srcBatch, 二值信号量只能被等待一次, 已等待过同一队列中更晚的批次时只扩大那次等待的阶段
+        void AddWait_Internal(uint32_t waitingBatch, uint32_t srcBatch, VkPipelineStageFlags stage) {
+            auto& last = lastWaits[batches[waitingBatch].queue];
+            if (last.srcBatch != UINT32_MAX &&
+                srcBatch <= last.srcBatch) {
+                batches[last.batch].waits[last.entry].second |= stage;
+                return;
+            }
+            batches[srcBatch].signal = true;
+            batches[waitingBatch].waits.push_back({ srcBatch, stage });
+            last = { srcBatch, waitingBatch, uint32_t(batches[waitingBatch].waits.size() - 1) };
+        }
+        // 模拟一次访问: 更新资源的状态, 向所在的pass（及跨队列时向先前的批次）添加所需的屏障和信号量等待
+        // attachmentSlot为该访问在渲染通道中的附件序号, 不是附件时为UINT32_MAX
+        void Access_Internal(resourceState& state, uint32_t compiledIndex, const pass::resourceAccess& access, uint32_t attachmentSlot) {
+            auto& current = compiledPasses[compiledIndex];
+            const accessInfo& info = accessInfos[access.type];
+            bool isImage = resources[access.resource].isImage;
+            queueType queue = batches[current.batch].queue;
+            bool discard = access.discard || !state.valid;
+            VkImageLayout oldLayout = discard ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+            VkImageLayout newLayout = isImage ? info.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+
+            // 读取先前作为附件写入的内容时, 写入时的storeOp须为VK_ATTACHMENT_STORE_OP_STORE
+            if (!access.discard &&
+                state.lastAttachmentWriter != UINT32_MAX)
+                compiledPasses[state.lastAttachmentWriter].storeOps[state.lastAttachmentSlot] = VK_ATTACHMENT_STORE_OP_STORE;
+            if (info.write)
+                state.lastAttachmentWriter = attachmentSlot == UINT32_MAX ? UINT32_MAX : compiledIndex,
+                state.lastAttachmentSlot = attachmentSlot;
+
+            bool synchronized = true;
+            if (state.queue != queue) {
+                // 跨队列: 等待先前访问该资源的批次, 内容有效时由该批次释放所有权, 由当前pass获取所有权
+                AddWait_Internal(current.batch, state.batch, info.stage);
+                if (!discard) {
+                    uint32_t srcQueueFamilyIndex = QueueFamilyIndex_Internal(state.queue);
+                    uint32_t dstQueueFamilyIndex = QueueFamilyIndex_Internal(queue);
+                    AddBarrier_Internal(batches[state.batch].releases, state.writeStages | state.readStages, 0,
+                        { access.resource, state.writeAccess, 0, oldLayout, newLayout, srcQueueFamilyIndex, dstQueueFamilyIndex });
+                    AddBarrier_Internal(current.barriers, 0, info.stage,
+                        { access.resource, 0, info.access, oldLayout, newLayout, srcQueueFamilyIndex, dstQueueFamilyIndex });
+                }
+                else if (isImage)
+                    AddBarrier_Internal(current.barriers, 0, info.stage,
+                        { access.resource, 0, info.access, oldLayout, newLayout, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED });
+            }
+            else if (info.write || oldLayout != newLayout) {
+                // 写入或布局转换: 等待先前所有的读写
+                VkPipelineStageFlags srcStages = state.writeStages | state.readStages;
+                if (srcStages || oldLayout != newLayout)
+                    AddBarrier_Internal(current.barriers, srcStages, info.stage,
+                        { access.resource, state.writeAccess, info.access, oldLayout, newLayout, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED });
+            }
+            else if (state.writeStages &&
+                ((info.stage & ~state.readStages) || (info.access & ~state.readAccess))) {
+                // 读取: 先前的写入尚未对该阶段及访问可见
+                AddBarrier_Internal(current.barriers, state.writeStages, info.stage,
+                    { access.resource, state.writeAccess, info.access, state.layout, state.layout, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED });
+                state.readStages |= info.stage;
+                state.readAccess |= info.access;
+                synchronized = false;
+            }
+            else
+                state.readStages |= info.stage,
+                synchronized = false;
+
+            // 经过屏障后, 之后的访问须与本次访问（及可能的布局转换）同步
+            if (synchronized) {
+                state.layout = newLayout;
+                state.writeStages = info.stage;
+                state.writeAccess = info.write ? info.access : 0;
+                state.readStages = info.write ? 0 : info.stage;
+                state.readAccess = info.write ? 0 : info.access;
+            }
+            state.valid |= info.write;
+            state.queue = queue;
+            state.batch = current.batch;
+        }
+        // 内部图像用作附件的pass及其附件序号
+        static uint32_t AttachmentSlot_Internal(const pass& pass, uint32_t accessIndex) {
+            for (size_t i = 0; i < pass.colorAttachments.size(); i++)
+                if (pass.colorAttachments[i].access == accessIndex)
+                    return uint32_t(i);
+            if (pass.depthStencilAttachment.access == accessIndex)
+                return uint32_t(pass.colorAttachments.size());
+            return UINT32_MAX;
+        }
+        result_t CreateRenderPass_Internal(compiledPass& compiled) {
+            const pass& source = passes[compiled.pass];
+            std::vector<VkAttachmentDescription> attachmentDescriptions;
+            std::vector<VkAttachmentReference> colorAttachmentReferences;
+            VkAttachmentReference depthStencilAttachmentReference = {};
+            auto AddAttachment = [&](const pass::attachment& attachment) {
+                auto& access = source.accesses[attachment.access];
+                auto& resource = resources[access.resource];
+                uint32_t slot = uint32_t(attachmentDescriptions.size());
+                VkImageLayout layout = accessInfos[access.type].layout;
+                attachmentDescriptions.push_back({
+                    .format = resource.format,
+                    .samples = resource.samples,
+                    .loadOp = attachment.loadOp,
+                    .storeOp = compiled.storeOps[slot],
+                    .stencilLoadOp = attachment.loadOp,
+                    .stencilStoreOp = compiled.storeOps[slot],
+                    // 布局转换由渲染通道以外的屏障完成
+                    .initialLayout = layout,
+                    .finalLayout = layout
+                });
+                compiled.clearValues.push_back(attachment.clearValue);
+                return VkAttachmentReference{ slot, layout };
+            };
+            for (auto& i : source.colorAttachments)
+                colorAttachmentReferences.push_back(AddAttachment(i));
+            bool hasDepthStencil = source.depthStencilAttachment.access != UINT32_MAX;
+            if (hasDepthStencil)
+                depthStencilAttachmentReference = AddAttachment(source.depthStencilAttachment);
+            VkSubpassDescription subpassDescription = {
+                .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+                .colorAttachmentCount = uint32_t(colorAttachmentReferences.size()),
+                .pColorAttachments = colorAttachmentReferences.data(),
+                .pDepthStencilAttachment = hasDepthStencil ? &depthStencilAttachmentReference : nullptr
+            };
+            VkRenderPassCreateInfo renderPassCreateInfo = {
+                .attachmentCount = uint32_t(attachmentDescriptions.size()),
+                .pAttachments = attachmentDescriptions.data(),
+                .subpassCount = 1,
+                .pSubpasses = &subpassDescription
+            };
+            uint32_t firstResource = source.accesses[hasDepthStencil && source.colorAttachments.empty() ?
+                source.depthStencilAttachment.access : source.colorAttachments[0].access].resource;
+            compiled.extent = resources[firstResource].imported ? extent : attachments.Extent(resources[firstResource].attachmentIndex);
+            return compiled.renderPass.Create(renderPassCreateInfo);
+        }
+        VkFramebuffer Framebuffer_Internal(compiledPass& compiled) {
+            const pass& pass = passes[compiled.pass];
+            std::vector<VkImageView> imageViews;
+            for (auto& i : pass.colorAttachments)
+                imageViews.push_back(ImageView(pass.accesses[i.access].resource));
+            if (pass.depthStencilAttachment.access != UINT32_MAX)
+                imageViews.push_back(ImageView(pass.accesses[pass.depthStencilAttachment.access].resource));
+            for (auto& i : compiled.framebuffers)
+                if (i.first == imageViews)
+                    return i.second;
+            // 外部图像（如交换链图像）数量有限, 超出上限时销毁最早的帧缓冲
+            if (compiled.framebuffers.size() == maxFramebufferCount)
+                compiled.framebuffers.front().second.DeferDestroy(),
+                compiled.framebuffers.pop_front();
+            VkFramebufferCreateInfo framebufferCreateInfo = {
+                .renderPass = compiled.renderPass,
+                .attachmentCount = uint32_t(imageViews.size()),
+                .pAttachments = imageViews.data(),
+                .width = compiled.extent.width,
+                .height = compiled.extent.height,
+                .layers = 1
+            };
+            vulkan::framebuffer framebuffer;
+            if (framebuffer.Create(framebufferCreateInfo))
+                return VK_NULL_HANDLE;
+            compiled.framebuffers.emplace_back(std::move(imageViews), std::move(framebuffer));
+            return compiled.framebuffers.back().second;
+        }
+        void CmdBarriers_Internal(VkCommandBuffer commandBuffer, const barrierBatch& barriers) {
+            for (auto& i : barriers.barriers) {
+                auto& resource = resources[i.resource];
+                if (resource.isImage)
+                    batcher.Image(Image(i.resource), { attachmentPool::AspectMask(resource.format), 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS },
+                        i.srcStages, i.srcAccess, i.dstStages, i.dstAccess,
+                        i.oldLayout, i.newLayout, i.srcQueueFamilyIndex, i.dstQueueFamilyIndex);
+                else
+                    batcher.Buffer(resource.buffer, i.srcStages, i.srcAccess, i.dstStages, i.dstAccess,
+                        0, resource.size, i.srcQueueFamilyIndex, i.dstQueueFamilyIndex);
+            }
+            batcher.Flush(commandBuffer);
+        }
+        // 先前编译的对象可能仍被执行中的帧使用, 延迟销毁
+        void DestroyCompiled_Internal() {
+            for (auto& i : compiledPasses) {
+                i.renderPass.DeferDestroy();
+                for (auto& j : i.framebuffers)
+                    j.second.DeferDestroy();
+            }
+            for (auto& i : commandPools)
+                i.DeferDestroy();
+            for (auto& i : semaphores)
+                i.DeferDestroy();
+            compiledIndices.clear();
+            compiledPasses.clear();
+            batches.clear();
+            commandPools.clear();
+            semaphores.clear();
+            attachments.Clear();
+            for (auto& i : resources)
+                i.attachmentIndex = UINT32_MAX;
+        }
+    public:
+        renderGraph() = default;
+        renderGraph(renderGraph&&) = delete;
+        //Getter
+        VkExtent2D Extent() const {
+            return extent;
+        }
+        uint32_t PassCount() const {
+            return uint32_t(passes.size());
+        }
+        // 未被剔除的pass数
+        uint32_t CompiledPassCount() const {
+            return uint32_t(compiledPasses.size());
+        }
+        uint32_t BatchCount() const {
+            return uint32_t(batches.size());
+        }
+        uint32_t BarrierCount() const {
+            size_t count = 0;
+            for (auto& i : compiledPasses)
+                count += i.barriers.barriers.size();
+            for (auto& i : batches)
+                count += i.releases.barriers.size();
+            return uint32_t(count);
+        }
+        bool IsCulled(uint32_t passIndex) const {
+            return compiledIndices[passIndex] == UINT32_MAX;
+        }
+        // pass所用的渲染通道, 用于创建管线, 每次Compile(...)后须重新取得
+        VkRenderPass RenderPass(uint32_t passIndex) const {
+            uint32_t compiledIndex = compiledIndices[passIndex];
+            return compiledIndex == UINT32_MAX ? VK_NULL_HANDLE : VkRenderPass(compiledPasses[compiledIndex].renderPass);
+        }
+        // 资源的图像或image view, 内部图像在Compile(...)后有效, 可用于在录制函数中更新描述符
+        VkImage Image(uint32_t resource) const {
+            auto& value = resources[resource];
+            if (value.imported)
+                return value.image;
+            return value.attachmentIndex == UINT32_MAX ? VK_NULL_HANDLE : attachments.Image(value.attachmentIndex);
+        }
+        VkImageView ImageView(uint32_t resource) const {
+            auto& value = resources[resource];
+            if (value.imported)
+                return value.imageView;
+            return value.attachmentIndex == UINT32_MAX ? VK_NULL_HANDLE : attachments.ImageView(value.attachmentIndex);
+        }
+        // 内部图像实际占用的内存大小, 及不共用内存时所需的大小
+        VkDeviceSize MemorySize() const {
+            return attachments.MemorySize();
+        }
+        VkDeviceSize UnaliasedMemorySize() const {
+            return attachments.UnaliasedMemorySize();
+        }
+        //Non-const Function
+        // 导入外部图像, 其内容在帧开始时处于initialLayout, 帧结束时被转换到finalLayout（为VK_IMAGE_LAYOUT_UNDEFINED时不转换）
+        // initialStage为帧开始前最后访问该图像的阶段, 对交换链图像而言, 可以是等待获取图像的信号量的阶段
+        uint32_t ImportImage(const char* name, VkFormat format, VkImageLayout initialLayout, VkImageLayout finalLayout,
+            VkPipelineStageFlags initialStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT) {
+            resources.push_back({
+                .name = name,
+                .imported = true,
+                .format = format,
+                .initialLayout = initialLayout,
+                .finalLayout = finalLayout,
+                .initialStage = initialStage
+            });
+            return uint32_t(resources.size() - 1);
+        }
+        // 导入外部缓冲区, 视作在帧开始前可能被任意阶段写入
+        uint32_t ImportBuffer(const char* name, VkBuffer buffer, VkDeviceSize size = VK_WHOLE_SIZE) {
+            resources.push_back({
+                .name = name,
+                .isImage = false,
+                .imported = true,
+                .buffer = buffer,
+                .size = size
+            });
+            return uint32_t(resources.size() - 1);
+        }
+        // 创建由渲染图管理的图像, 尺寸为Compile(...)所指定的尺寸乘以scale, 用途由各pass的访问推断, 内容在每帧开始时未定义
+        uint32_t CreateImage(const char* name, VkFormat format, float scale = 1.f, VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT) {
+            resources.push_back({
+                .name = name,
+                .format = format,
+                .samples = samples,
+                .scale = scale
+            });
+            return uint32_t(resources.size() - 1);
+        }
+        // 每帧执行前更新外部图像（如当前的交换链图像）
+        void SetImportedImage(uint32_t resource, VkImage image, VkImageView imageView) {
+            resources[resource].image = image;
+            resources[resource].imageView = imageView;
+        }
+        void SetImportedBuffer(uint32_t resource, VkBuffer buffer) {
+            resources[resource].buffer = buffer;
+        }
+        // 使内部图像的内容在帧末被保留, 写入它的pass不被剔除
+        void MarkOutput(uint32_t resource) {
+            resources[resource].output = true;
+        }
+        pass& AddPass(const char* name, queueType queue = queue_graphics) {
+            passes.push_back(pass(name, uint32_t(passes.size()), queue));
+            return passes.back();
+        }
+        // 编译渲染图, 在添加pass后及尺寸改变时（如在交换链的创建回调中）调用, frameSlotCount为即时帧的槽位数
+        result_t Compile(VkExtent2D extent, uint32_t frameSlotCount) {
+            DestroyCompiled_Internal();
+            this->extent = extent;
+            this->frameSlotCount = frameSlotCount;
+
+            // 自后向前剔除pass: 写入被需要的资源或有副作用的pass被保留, 并使其读取的资源被需要; 不保留内容的写入使该资源在此前不被需要
+            std::vector<bool> needed(resources.size());
+            for (size_t i = 0; i < resources.size(); i++)
+                needed[i] = resources[i].imported || resources[i].output;
+            std::vector<bool> kept(passes.size());
+            for (size_t i = passes.size(); i--;) {
+                auto& pass = passes[i];
+                bool keep = pass.sideEffect;
+                for (auto& j : pass.accesses)
+                    keep |= accessInfos[j.type].write && needed[j.resource];
+                if (!keep)
+                    continue;
+                kept[i] = true;
+                for (auto& j : pass.accesses)
+                    if (j.discard)
+                        needed[j.resource] = resources[j.resource].imported || resources[j.resource].output;
+                for (auto& j : pass.accesses)
+                    if (!j.discard)
+                        needed[j.resource] = true;
+            }
+
+            // 分配队列并划分批次, 使用计算队列时, 批次0总是图形队列的批次, 帧开始时所有资源视作属于该批次
+            bool asyncCompute =
+                graphicsBase::Base().QueueFamilyIndex_Compute() != VK_QUEUE_FAMILY_IGNORED &&
+                graphicsBase::Base().QueueFamilyIndex_Compute() != graphicsBase::Base().QueueFamilyIndex_Graphics();
+            compiledIndices.assign(passes.size(), UINT32_MAX);
+            batches.push_back({ queue_graphics });
+            bool usesComputeQueue = false;
+            for (uint32_t i = 0; i < passes.size(); i++) {
+                if (!kept[i])
+                    continue;
+                auto& pass = passes[i];
+                queueType queue = queue_graphics;
+                if (asyncCompute &&
+                    pass.queue == queue_asyncCompute &&
+                    pass.colorAttachments.empty() &&
+                    pass.depthStencilAttachment.access == UINT32_MAX &&
+                    std::ranges::all_of(pass.accesses, [](auto& j) { return !(accessInfos[j.type].stage & ~computeQueueStages); }))
+                    queue = queue_asyncCompute,
+                    usesComputeQueue = true;
+                if (batches.back().queue != queue)
+                    batches.push_back({ queue });
+                compiledIndices[i] = uint32_t(compiledPasses.size());
+                batches.back().compiledPasses.push_back(uint32_t(compiledPasses.size()));
+                auto& compiled = compiledPasses.emplace_back();
+                compiled.pass = i;
+                compiled.batch = uint32_t(batches.size() - 1);
+                compiled.storeOps.resize(pass.colorAttachments.size() + 1, VK_ATTACHMENT_STORE_OP_DONT_CARE);
+                if (pass.depthStencilAttachment.access != UINT32_MAX &&
+                    pass.accesses[pass.depthStencilAttachment.access].type == access_depthStencilReadOnly)
+                    compiled.storeOps.back() = VK_ATTACHMENT_STORE_OP_STORE;
+            }
+
+            // 内部图像: 由访问推断用途; 在计算队列中被访问的图像不与其他图像共用内存, 以免跨队列的内存别名需要额外的同步
+            struct lifetime {
+                uint32_t firstPass = UINT32_MAX;
+                uint32_t lastPass = 0;
+                VkImageUsageFlags usage = 0;
+                bool attachmentOnly = true;
+                bool computeQueue = false;
+            };
+            std::vector<lifetime> lifetimes(resources.size());
+            VkPipelineStageFlags transientStages = 0;
+            VkAccessFlags transientWriteAccess = 0;
+            for (uint32_t i = 0; i < compiledPasses.size(); i++)
+                for (auto& j : passes[compiledPasses[i].pass].accesses) {
+                    auto& resource = resources[j.resource];
+                    if (resource.imported)
+                        continue;
+                    auto& info = accessInfos[j.type];
+                    auto& value = lifetimes[j.resource];
+                    value.firstPass = std::min(value.firstPass, i);
+                    value.lastPass = std::max(value.lastPass, i);
+                    value.usage |= info.usage;
+                    value.attachmentOnly &=
+                        j.type == access_colorAttachment ||
+                        j.type == access_depthStencilAttachment ||
+                        j.type == access_depthStencilReadOnly;
+                    if (batches[compiledPasses[i].batch].queue == queue_asyncCompute)
+                        value.computeQueue = true;
+                    else
+                        transientStages |= info.stage,
+                        transientWriteAccess |= info.write ? info.access : 0;
+                }
+            for (size_t i = 0; i < resources.size(); i++) {
+                auto& value = lifetimes[i];
+                if (resources[i].imported ||
+                    value.firstPass == UINT32_MAX)
+                    continue;
+                // 只在一个渲染通道中作为附件使用的图像无需写回内存
+                bool transient = value.attachmentOnly && value.firstPass == value.lastPass && !resources[i].output;
+                resources[i].attachmentIndex = attachments.Add({
+                    .format = resources[i].format,
+                    .usage = value.usage | (transient ? VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT : 0),
+                    .samples = resources[i].samples,
+                    .firstPass = value.computeQueue ? 0 : value.firstPass,
+                    .lastPass = value.computeQueue ? UINT32_MAX : value.lastPass,
+                    .scale = resources[i].scale
+                });
+            }
+            if (attachments.AttachmentCount())
+                if (VkResult result = attachments.Create(extent))
+                    return result;
+
+            // 模拟执行以计算屏障, 内部图像的首次使用须等待上一帧及共用内存的图像在图形队列中的访问
+            std::vector<resourceState> states(resources.size());
+            for (size_t i = 0; i < resources.size(); i++) {
+                auto& resource = resources[i];
+                auto& state = states[i];
+                if (!resource.imported)
+                    state.writeStages = transientStages,
+                    state.writeAccess = transientWriteAccess;
+                else if (resource.isImage)
+                    state.layout = resource.initialLayout,
+                    state.writeStages = resource.initialStage,
+                    state.valid = resource.initialLayout != VK_IMAGE_LAYOUT_UNDEFINED,
+                    state.writeAccess = state.valid ? VK_ACCESS_MEMORY_WRITE_BIT : 0;
+                else
+                    state.writeStages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                    state.writeAccess = VK_ACCESS_MEMORY_WRITE_BIT,
+                    state.valid = true;
+            }
+            lastWaits[0] = lastWaits[1] = {};
+            for (uint32_t i = 0; i < compiledPasses.size(); i++) {
+                auto& pass = passes[compiledPasses[i].pass];
+                for (uint32_t j = 0; j < pass.accesses.size(); j++)
+                    Access_Internal(states[pass.accesses[j].resource], i, pass.accesses[j], AttachmentSlot_Internal(pass, j));
+            }
+
+            // 帧末: 计算队列的批次均须被之后的图形批次等待, 使提交最后一个批次时的栅栏覆盖整帧; 外部资源须回到图形队列并转换到最终布局
+            if (usesComputeQueue &&
+                batches.back().queue != queue_graphics)
+                batches.push_back({ queue_graphics });
+            uint32_t lastBatch = uint32_t(batches.size() - 1);
+            for (uint32_t i = 0; i < resources.size(); i++) {
+                auto& resource = resources[i];
+                auto& state = states[i];
+                if (state.lastAttachmentWriter != UINT32_MAX &&
+                    (resource.imported || resource.output))
+                    compiledPasses[state.lastAttachmentWriter].storeOps[state.lastAttachmentSlot] = VK_ATTACHMENT_STORE_OP_STORE;
+                if (!resource.imported)
+                    continue;
+                VkImageLayout finalLayout = resource.isImage && resource.finalLayout != VK_IMAGE_LAYOUT_UNDEFINED ? resource.finalLayout : state.layout;
+                if (state.queue != queue_graphics) {
+                    uint32_t srcQueueFamilyIndex = QueueFamilyIndex_Internal(state.queue);
+                    uint32_t dstQueueFamilyIndex = QueueFamilyIndex_Internal(queue_graphics);
+                    AddWait_Internal(lastBatch, state.batch, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+                    AddBarrier_Internal(batches[state.batch].releases, state.writeStages | state.readStages, 0,
+                        { i, state.writeAccess, 0, state.layout, finalLayout, srcQueueFamilyIndex, dstQueueFamilyIndex });
+                    AddBarrier_Internal(batches[lastBatch].releases, 0, 0,
+                        { i, 0, 0, state.layout, finalLayout, srcQueueFamilyIndex, dstQueueFamilyIndex });
+                }
+                else if (finalLayout != state.layout)
+                    AddBarrier_Internal(batches[lastBatch].releases, state.writeStages | state.readStages, 0,
+                        { i, state.writeAccess, 0, state.layout, finalLayout, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED });
+            }
+            for (uint32_t i = lastBatch; i--;)
+                if (batches[i].queue == queue_asyncCompute) {
+                    AddWait_Internal(lastBatch, i, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+                    break;
+                }
+
+            // 创建渲染通道、命令池及批次间的信号量
+            for (auto& i : compiledPasses)
+                if (passes[i.pass].colorAttachments.size() ||
+                    passes[i.pass].depthStencilAttachment.access != UINT32_MAX)
+                    if (VkResult result = CreateRenderPass_Internal(i))
+                        return result;
+            commandPools.resize(size_t(frameSlotCount) * 2);
+            for (uint32_t i = 0; i < frameSlotCount; i++) {
+                if (VkResult result = commandPools[i * 2 + queue_graphics].Create(QueueFamilyIndex_Internal(queue_graphics)))
+                    return result;
+                if (usesComputeQueue)
+                    if (VkResult result = commandPools[i * 2 + queue_asyncCompute].Create(QueueFamilyIndex_Internal(queue_asyncCompute)))
+                        return result;
+            }
+            if (batches.size() > 1)
+                semaphores.resize(size_t(frameSlotCount) * batches.size());
+            return VK_SUCCESS;
+        }
+        // 录制并提交各批次, 调用前须确保该帧槽位先前的命令已执行完毕（如已等待frameContext中对应槽位的栅栏）
+        // waitSemaphores由首个含pass的图形批次等待, signalSemaphores和fence由最后一个批次（总是图形批次）置位
+        result_t Execute(uint32_t frameSlot, arrayRef<const semaphoreSubmitInfo> waitSemaphores = {}, arrayRef<const semaphoreSubmitInfo> signalSemaphores = {}, VkFence fence = VK_NULL_HANDLE) {
+            frameSlot %= frameSlotCount;
+            for (uint32_t i = 0; i < 2; i++)
+                if (commandPools[frameSlot * 2 + i])
+                    if (VkResult result = commandPools[frameSlot * 2 + i].Reset())
+                        return result;
+            uint32_t externalWaitBatch = 0;
+            for (uint32_t i = 0; i < batches.size(); i++)
+                if (batches[i].queue == queue_graphics &&
+                    batches[i].compiledPasses.size()) {
+                    externalWaitBatch = i;
+                    break;
+                }
+            std::vector<semaphoreSubmitInfo> waits;
+            std::vector<semaphoreSubmitInfo> signals;
+            for (uint32_t i = 0; i < batches.size(); i++) {
+                auto& batch = batches[i];
+                bool last = i + 1 == batches.size();
+                waits.clear();
+                signals.clear();
+                for (auto& j : batch.waits)
+                    waits.push_back({ semaphores[frameSlot * batches.size() + j.first], 0, j.second });
+                if (i == externalWaitBatch)
+                    for (auto& j : waitSemaphores)
+                        waits.push_back(j);
+                if (batch.signal)
+                    signals.push_back({ semaphores[frameSlot * batches.size() + i] });
+                if (last)
+                    for (auto& j : signalSemaphores)
+                        signals.push_back(j);
+
+                auto pCommandBuffer = commandPools[frameSlot * 2 + batch.queue].Next();
+                if (!pCommandBuffer)
+                    return VK_RESULT_MAX_ENUM;
+                const vulkan::commandBuffer& commandBuffer = *pCommandBuffer;
+                if (VkResult result = commandBuffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT))
+                    return result;
+                // 信号量等待只作用于同一批次中的命令, 有多个批次时以屏障将其延伸到之后的批次
+                if (batches.size() > 1) {
+                    VkPipelineStageFlags waitStages = 0;
+                    for (auto& j : waits)
+                        waitStages |= j.stage;
+                    if (waitStages)
+                        vkCmdPipelineBarrier(commandBuffer, waitStages, waitStages, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+                }
+                for (uint32_t j : batch.compiledPasses) {
+                    auto& compiled = compiledPasses[j];
+                    auto& pass = passes[compiled.pass];
+                    CmdBarriers_Internal(commandBuffer, compiled.barriers);
+                    if (compiled.renderPass) {
+                        VkFramebuffer framebuffer = Framebuffer_Internal(compiled);
+                        if (!framebuffer)
+                            return VK_RESULT_MAX_ENUM;
+                        compiled.renderPass.CmdBegin(commandBuffer, framebuffer, { {}, compiled.extent }, { compiled.clearValues.data(), compiled.clearValues.size() });
+                    }
+                    if (pass.execute)
+                        pass.execute(commandBuffer);
+                    if (compiled.renderPass)
+                        compiled.renderPass.CmdEnd(commandBuffer);
+                }
+                CmdBarriers_Internal(commandBuffer, batch.releases);
+                if (VkResult result = commandBuffer.End())
+                    return result;
+                VkFence batchFence = last ? fence : VK_NULL_HANDLE;
+                if (VkResult result = batch.queue == queue_graphics ?
+                    graphicsBase::Base().SubmitCommandBuffer_Graphics(commandBuffer, { waits.data(), waits.size() }, { signals.data(), signals.size() }, batchFence) :
+                    graphicsBase::Base().SubmitCommandBuffer_Compute(commandBuffer, { waits.data(), waits.size() }, { signals.data(), signals.size() }, batchFence))
+                    return result;
+            }
+            return VK_SUCCESS;
+        }
+        // 移除所有pass和资源, 用于重新构建渲染图
+        void Clear() {
+            DestroyCompiled_Internal();
+            passes.clear();
+            resources.clear();
+        }
+    };
+    // GPU驱动的绘制: 各物体的包围球和绘制参数存于storage buffer, CmdCull(...)以计算着色器（见FrustumCulling.comp.shader）做视锥剔除,
+    // 将可见物体的VkDrawIndexedIndirectCommand紧密写入间接缓冲区并计数, CmdDraw(...)以vkCmdDrawIndexedIndirectCount(...)消耗之, CPU一侧的开销与物体数量无关
+    // 不支持vkCmdDrawIndexedIndirectCount时计算着色器不压缩输出, 被剔除的物体的instanceCount为0, 以vkCmdDrawIndexedIndirect(...)提交全部物体
+    // 各间接绘制命令的firstInstance为物体索引, 顶点着色器可以gl_InstanceIndex索引逐物体的数据, 这要求drawIndirectFirstInstance特性
+    // 物体数据通过asyncUploader等写入ObjectBoundsBuffer()和DrawParametersBuffer(), 前者亦可作为逐实例的顶点缓冲区
+    class indirectDrawCuller {
+    public:
+        struct objectBounds {
+            glm::vec3 center;
+            float radius;
+        };
+        struct drawParameters {
+            uint32_t indexCount;
+            uint32_t firstIndex;
+            int32_t vertexOffset;
+            uint32_t padding = 0;
+        };
+    private:
+        struct pushConstants {
+            glm::vec4 frustumPlanes[6];
+            uint32_t objectCount;
+            uint32_t compact;
+        };
+        static constexpr uint32_t localSize = 64;
+        vulkan::descriptorSetLayout descriptorSetLayout;
+        vulkan::pipelineLayout pipelineLayout;
+        vulkan::pipeline pipeline;
+        vulkan::descriptorPool descriptorPool;
+        vulkan::descriptorSet descriptorSet;
+        vulkan::buffer buffer_objectBounds;
+        vulkan::buffer buffer_drawParameters;
+        vulkan::buffer buffer_drawCommands;
+        vulkan::buffer buffer_drawCount;
+        uint32_t objectCount = 0;
+        vulkan::barrierBatcher batcher;
+        //--------------------
+        bool Compact_Internal() const {
+            return graphicsBase::Base().CmdDrawIndexedIndirectCount();
+        }
+    public:
+        indirectDrawCuller() = default;
+        indirectDrawCuller(const char* shaderPath) {
+            Create(shaderPath);
+        }
+        indirectDrawCuller(indirectDrawCuller&&) = delete;
+        //Getter
+        uint32_t ObjectCount() const { return objectCount; }
+        VkBuffer ObjectBoundsBuffer() const { return buffer_objectBounds; }
+        VkBuffer DrawParametersBuffer() const { return buffer_drawParameters; }
+        VkBuffer DrawCommandBuffer() const { return buffer_drawCommands; }
+        VkBuffer DrawCountBuffer() const { return buffer_drawCount; }
+        //Const Function
+        // 在渲染通道内录制间接绘制命令, 调用前须绑定图形管线、顶点缓冲区和索引缓冲区, 且同一帧中已于渲染通道外录制CmdCull(...)
+        void CmdDraw(VkCommandBuffer commandBuffer) const {
+            if (!objectCount)
+                return;
+            constexpr uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+            if (auto CmdDrawIndexedIndirectCount = graphicsBase::Base().CmdDrawIndexedIndirectCount())
+                CmdDrawIndexedIndirectCount(commandBuffer, buffer_drawCommands, 0, buffer_drawCount, 0, objectCount, stride);
+            else if (graphicsBase::Base().PhysicalDeviceFeatures().multiDrawIndirect)
+                vkCmdDrawIndexedIndirect(commandBuffer, buffer_drawCommands, 0, objectCount, stride);
+            // 不支持multiDrawIndirect时每次只能提交一个间接绘制命令
+            else
+                for (uint32_t i = 0; i < objectCount; i++)
+                    vkCmdDrawIndexedIndirect(commandBuffer, buffer_drawCommands, VkDeviceSize(i) * stride, 1, stride);
+        }
+        //Non-const Function
+        // 在渲染通道外录制视锥剔除, viewProjection为裁剪空间深度范围为[0, 1]的观察投影矩阵
+        void CmdCull(VkCommandBuffer commandBuffer, const glm::mat4& viewProjection) {
+            if (!objectCount)
+                return;
+            // 先前的帧可能仍在读取间接缓冲区
+            batcher.Global(VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0).Flush(commandBuffer);
+            if (Compact_Internal()) {
+                vkCmdFillBuffer(commandBuffer, buffer_drawCount, 0, sizeof(uint32_t), 0);
+                batcher.Buffer(buffer_drawCount,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT).Flush(commandBuffer);
+            }
+            pushConstants constants = {
+                .objectCount = objectCount,
+                .compact = Compact_Internal()
+            };
+            FrustumPlanes(viewProjection, constants.frustumPlanes);
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, descriptorSet.Address(), 0, nullptr);
+            vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof constants, &constants);
+            vkCmdDispatch(commandBuffer, (objectCount + localSize - 1) / localSize, 1, 1);
+            batcher.Buffer(buffer_drawCommands,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+            if (Compact_Internal())
+                batcher.Buffer(buffer_drawCount,
+                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                    VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+            batcher.Flush(commandBuffer);
+        }
+        // 为objectCount个物体创建缓冲区, 先前的缓冲区被延迟销毁, 其内容不被保留
+        result_t SetObjectCount(uint32_t objectCount) {
+            buffer_objectBounds.DeferDestroy();
+            buffer_drawParameters.DeferDestroy();
+            buffer_drawCommands.DeferDestroy();
+            buffer_drawCount.DeferDestroy();
+            descriptorPool.DeferDestroy();
+            this->objectCount = 0;
+            if (!objectCount)
+                return VK_SUCCESS;
+            if (VkResult result = buffer_objectBounds.Create(sizeof(objectBounds) * objectCount,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
+                return result;
+            if (VkResult result = buffer_drawParameters.Create(sizeof(drawParameters) * objectCount,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
+                return result;
+            if (VkResult result = buffer_drawCommands.Create(sizeof(VkDrawIndexedIndirectCommand) * objectCount,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
+                return result;
+            if (VkResult result = buffer_drawCount.Create(sizeof(uint32_t),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
+                return result;
+            // 描述符集可能仍被执行中的帧使用, 与缓冲区一同重建而不更新
+            VkDescriptorPoolSize poolSize = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4 };
+            if (VkResult result = descriptorPool.Create(1, poolSize))
+                return result;
+            if (VkResult result = descriptorPool.AllocateSets(descriptorSet, descriptorSetLayout))
+                return result;
+            VkDescriptorBufferInfo bufferInfos[] = {
+                { buffer_objectBounds, 0, VK_WHOLE_SIZE },
+                { buffer_drawParameters, 0, VK_WHOLE_SIZE },
+                { buffer_drawCommands, 0, VK_WHOLE_SIZE },
+                { buffer_drawCount, 0, VK_WHOLE_SIZE }
+            };
+            descriptorSet.Write(bufferInfos, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+            this->objectCount = objectCount;
+            return VK_SUCCESS;
+        }
+        result_t Create(const char* shaderPath = "shader/FrustumCulling.comp.spv") {
+            if (!graphicsBase::Base().PhysicalDeviceFeatures().drawIndirectFirstInstance)
+                outStream << std::format("[ indirectDrawCuller ] WARNING\ndrawIndirectFirstInstance is not supported, gl_InstanceIndex will always be 0!\n");
+            VkDescriptorSetLayoutBinding bindings[4] = {};
+            for (uint32_t i = 0; i < 4; i++)
+                bindings[i] = { i, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT };
+            VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
+                .bindingCount = 4,
+                .pBindings = bindings
+            };
+            if (VkResult result = descriptorSetLayout.Create(descriptorSetLayoutCreateInfo))
+                return result;
+            VkPushConstantRange pushConstantRange = { VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants) };
+            VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
+                .setLayoutCount = 1,
+                .pSetLayouts = descriptorSetLayout.Address(),
+                .pushConstantRangeCount = 1,
+                .pPushConstantRanges = &pushConstantRange
+            };
+            if (VkResult result = pipelineLayout.Create(pipelineLayoutCreateInfo))
+                return result;
+            shaderModule shader;
+            if (VkResult result = shader.Create(shaderPath))
+                return result;
+            VkComputePipelineCreateInfo pipelineCreateInfo = {
+                .stage = shader.StageCreateInfo(VK_SHADER_STAGE_COMPUTE_BIT),
+                .layout = pipelineLayout
+            };
+            return pipeline.Create(pipelineCreateInfo);
+        }
+        //Static Function
+        // 从观察投影矩阵中提取视锥的六个平面, 法向朝内, xyz已归一化
+        static void FrustumPlanes(const glm::mat4& viewProjection, glm::vec4(&planes)[6]) {
+            glm::vec4 rows[4];
+            for (int i = 0; i < 4; i++)
+                rows[i] = { viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i] };
+            planes[0] = rows[3] + rows[0];
+            planes[1] = rows[3] - rows[0];
+            planes[2] = rows[3] + rows[1];
+            planes[3] = rows[3] - rows[1];
+            planes[4] = rows[2];
+            planes[5] = rows[3] - rows[2];
+            for (auto& i : planes)
+                i /= glm::length(glm::vec3(i));
+        }
+    };
+    // 绘制队列, 每帧收集绘制, Flush(...)时按64位排序键做基数排序后录制, 以减少管线和描述符集的切换:
+    // sortMode_state时排序键自高位起依次为管线（10位）、描述符集（12位）、顶点缓冲区（10位）、几何（8位）、深度（24位）, 同一状态下的绘制由近及远, 适于不透明物体
+    // sortMode_backToFront时深度（由远及近）位于最高的24位, 其后为各状态, 适于半透明物体
+    // 录制时省略与当前绑定相同的管线、描述符集、顶点缓冲区和索引缓冲区; 排序后相邻且状态和几何均相同的绘制被合并为一次实例化绘制
+    // 逐实例数据按排序后的顺序写入uploadRing, 并绑定到instanceBinding所指定的顶点输入绑定, 各绘制的firstInstance即其实例数据的索引; 实例数据的大小为0时不合并绘制
+    // 各状态在键中的编号逐帧按首次出现的顺序分配, 超出位数时共用最大的编号, 此时仅排序效果变差, 绑定和合并仍按实际的句柄判断
+    // 非线程安全, 须在同一线程中调用
+    class drawQueue {
+    public:
+        enum sortMode {
+            sortMode_state,
+            sortMode_backToFront
+        };
+        struct geometry {
+            VkBuffer vertexBuffer = VK_NULL_HANDLE;
+            VkDeviceSize vertexBufferOffset = 0;
+            // 为VK_NULL_HANDLE时以vkCmdDraw(...)绘制
+            VkBuffer indexBuffer = VK_NULL_HANDLE;
+            VkDeviceSize indexBufferOffset = 0;
+            VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+            // 索引数或顶点数
+            uint32_t count = 0;
+            // 首个索引或首个顶点
+            uint32_t first = 0;
+            // 仅用于索引绘制
+            int32_t vertexOffset = 0;
+            //--------------------
+            bool operator==(const geometry&) const = default;
+        };
+        struct draw {
+            VkPipeline pipeline = VK_NULL_HANDLE;
+            VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+            // 绑定到set 0, 为VK_NULL_HANDLE时不绑定
+            VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+            drawQueue::geometry geometry;
+            // 规范化到[0, 1]的深度, 越小越近
+            float depth = 0;
+        };
+        // 最近一次Flush(...)的统计
+        struct statistics {
+            uint32_t drawCount = 0;
+            uint32_t drawCallCount = 0;
+            uint32_t pipelineBindCount = 0;
+            uint32_t descriptorSetBindCount = 0;
+            uint32_t vertexBufferBindCount = 0;
+            uint32_t indexBufferBindCount = 0;
+        };
+    private:
+        struct sortEntry {
+            uint64_t key;
+            uint32_t index;
+        };
+        struct geometryHash {
+            size_t operator()(const geometry& value) const {
+                return std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char*>(&value), sizeof value));
+            }
+        };
+        static_assert(std::has_unique_object_representations_v<geometry>, "geometry must have no padding to be hashed bytewise.");
+        static constexpr uint32_t pipelineBits = 10;
+        static constexpr uint32_t descriptorSetBits = 12;
+        static constexpr uint32_t vertexBufferBits = 10;
+        static constexpr uint32_t geometryBits = 8;
+        static constexpr uint32_t depthBits = 24;
+        static_assert(pipelineBits + descriptorSetBits + vertexBufferBits + geometryBits + depthBits == 64);
+        sortMode mode = sortMode_state;
+        uint32_t instanceDataSize = 0;
+        uint32_t instanceBinding = 1;
+        std::vector<draw> draws;
+        std::vector<uint8_t> instanceData;
+        std::vector<sortEntry> entries;
+        std::vector<sortEntry> scratch;
+        std::unordered_map<uint64_t, uint32_t> pipelineIds;
+        std::unordered_map<uint64_t, uint32_t> descriptorSetIds;
+        std::unordered_map<uint64_t, uint32_t> vertexBufferIds;
+        // 几何的编号在其顶点缓冲区内分配, 下标为顶点缓冲区的编号
+        std::unordered_map<geometry, uint32_t, geometryHash> geometryIds;
+        std::vector<uint32_t> geometryCounts;
+        statistics lastStatistics = {};
+        //--------------------
+        static uint32_t Id_Internal(std::unordered_map<uint64_t, uint32_t>& ids, uint64_t handle, uint32_t bits) {
+            auto [iterator, inserted] = ids.try_emplace(handle, uint32_t(ids.size()));
+            return std::min(iterator->second, (1u << bits) - 1);
+        }
+        uint64_t Key_Internal(const draw& value) {
+            uint64_t pipelineId = Id_Internal(pipelineIds, uint64_t(value.pipeline), pipelineBits);
+            uint64_t descriptorSetId = Id_Internal(descriptorSetIds, uint64_t(value.descriptorSet), descriptorSetBits);
+            uint32_t vertexBufferId = Id_Internal(vertexBufferIds, uint64_t(value.geometry.vertexBuffer), vertexBufferBits);
+            if (vertexBufferId >= geometryCounts.size())
+                geometryCounts.resize(vertexBufferId + 1);
+            auto [iterator, inserted] = geometryIds.try_emplace(value.geometry, geometryCounts[vertexBufferId]);
+            if (inserted)
+                geometryCounts[vertexBufferId]++;
+            uint64_t geometryId = std::min(iterator->second, (1u << geometryBits) - 1);
+            uint64_t depth = uint64_t(std::clamp(value.depth, 0.f, 1.f) * float((1 << depthBits) - 1));
+            uint64_t state = pipelineId << (descriptorSetBits + vertexBufferBits + geometryBits) |
+                descriptorSetId << (vertexBufferBits + geometryBits) |
+                uint64_t(vertexBufferId) << geometryBits |
+                geometryId;
+            if (mode == sortMode_backToFront)
+                return ((1ull << depthBits) - 1 - depth) << (64 - depthBits) | state;
+            return state << depthBits | depth;
+        }
+        // 以8位为一位数的LSD基数排序, 跳过所有键在该位上相同的趟
+        void Sort_Internal() {
+            size_t count = entries.size();
+            scratch.resize(count);
+            uint32_t histograms[8][256] = {};
+            for (auto& i : entries)
+                for (uint32_t j = 0; j < 8; j++)
+                    histograms[j][i.key >> j * 8 & 0xff]++;
+            for (uint32_t j = 0; j < 8; j++) {
+                uint32_t* histogram = histograms[j];
+                if (histogram[entries[0].key >> j * 8 & 0xff] == count)
+                    continue;
+                uint32_t offset = 0;
+                for (uint32_t k = 0; k < 256; k++) {
+                    uint32_t digitCount = histogram[k];
+                    histogram[k] = offset;
+                    offset += digitCount;
+                }
+                for (auto& i : entries)
+                    scratch[histogram[i.key >> j * 8 & 0xff]++] = i;
+                entries.swap(scratch);
+            }
+        }
+        bool Mergeable_Internal(const draw& a, const draw& b) const {
+            return instanceDataSize &&
+                a.pipeline == b.pipeline &&
+                a.pipelineLayout == b.pipelineLayout &&
+                a.descriptorSet == b.descriptorSet &&
+                a.geometry == b.geometry;
+        }
+    public:
+        drawQueue() = default;
+        drawQueue(sortMode mode, uint32_t instanceDataSize = 0, uint32_t instanceBinding = 1) {
+            Create(mode, instanceDataSize, instanceBinding);
+        }
+        //Getter
+        uint32_t DrawCount() const {
+            return uint32_t(draws.size());
+        }
+        const statistics& Statistics() const {
+            return lastStatistics;
+        }
+        //Non-const Function
+        // pInstanceData指向instanceDataSize字节的逐实例数据, 实例数据的大小为0时被忽略
+        void Push(const draw& value, const void* pInstanceData = nullptr) {
+            draws.push_back(value);
+            if (instanceDataSize) {
+                size_t offset = instanceData.size();
+                instanceData.resize(offset + instanceDataSize);
+                if (pInstanceData)
+                    memcpy(instanceData.data() + offset, pInstanceData, instanceDataSize);
+            }
+        }
+        // 排序并录制所有绘制, 然后清空队列, 须在渲染通道中调用; 逐实例数据从ring中分配, 其缓冲区的用途须包含VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
+        result_t Flush(VkCommandBuffer commandBuffer, uploadRing& ring) {
+            lastStatistics = { .drawCount = uint32_t(draws.size()) };
+            if (draws.empty())
+                return VK_SUCCESS;
+            uploadRing::suballocation instances;
+            if (instanceDataSize &&
+                !(instances = ring.Allocate(instanceData.size()))) {
+                Clear();
+                return VK_RESULT_MAX_ENUM;
+            }
+            entries.resize(draws.size());
+            for (size_t i = 0; i < draws.size(); i++)
+                entries[i] = { Key_Internal(draws[i]), uint32_t(i) };
+            Sort_Internal();
+            // 按排序后的顺序写入实例数据, 使合并的绘制的实例数据连续
+            if (instanceDataSize) {
+                for (size_t i = 0; i < entries.size(); i++)
+                    memcpy(static_cast<uint8_t*>(instances.pData) + i * instanceDataSize, instanceData.data() + size_t(entries[i].index) * instanceDataSize, instanceDataSize);
+                vkCmdBindVertexBuffers(commandBuffer, instanceBinding, 1, &instances.buffer, &instances.offset);
+                lastStatistics.vertexBufferBindCount++;
+            }
+            // 当前的绑定, 不绑定描述符集或索引缓冲区的绘制不改变先前的绑定
+            VkPipeline boundPipeline = VK_NULL_HANDLE;
+            VkPipelineLayout boundPipelineLayout = VK_NULL_HANDLE;
+            VkDescriptorSet boundDescriptorSet = VK_NULL_HANDLE;
+            VkBuffer boundVertexBuffer = VK_NULL_HANDLE;
+            VkDeviceSize boundVertexBufferOffset = 0;
+            VkBuffer boundIndexBuffer = VK_NULL_HANDLE;
+            VkDeviceSize boundIndexBufferOffset = 0;
+            VkIndexType boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+            for (size_t i = 0; i < entries.size();) {
+                const draw& current = draws[entries[i].index];
+                uint32_t instanceCount = 1;
+                while (i + instanceCount < entries.size() &&
+                    Mergeable_Internal(current, draws[entries[i + instanceCount].index]))
+                    instanceCount++;
+                if (boundPipeline != current.pipeline)
+                    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, current.pipeline),
+                    boundPipeline = current.pipeline,
+                    lastStatistics.pipelineBindCount++;
+                if (current.descriptorSet &&
+                    (boundDescriptorSet != current.descriptorSet || boundPipelineLayout != current.pipelineLayout))
+                    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, current.pipelineLayout, 0, 1, &current.descriptorSet, 0, nullptr),
+                    boundDescriptorSet = current.descriptorSet,
+                    boundPipelineLayout = current.pipelineLayout,
+                    lastStatistics.descriptorSetBindCount++;
+                const drawQueue::geometry& geometry = current.geometry;
+                if (geometry.vertexBuffer &&
+                    (boundVertexBuffer != geometry.vertexBuffer || boundVertexBufferOffset != geometry.vertexBufferOffset))
+                    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &geometry.vertexBuffer, &geometry.vertexBufferOffset),
+                    boundVertexBuffer = geometry.vertexBuffer,
+                    boundVertexBufferOffset = geometry.vertexBufferOffset,
+                    lastStatistics.vertexBufferBindCount++;
+                if (geometry.indexBuffer &&
+                    (boundIndexBuffer != geometry.indexBuffer || boundIndexBufferOffset != geometry.indexBufferOffset || boundIndexType != geometry.indexType))
+                    vkCmdBindIndexBuffer(commandBuffer, geometry.indexBuffer, geometry.indexBufferOffset, geometry.indexType),
+                    boundIndexBuffer = geometry.indexBuffer,
+                    boundIndexBufferOffset = geometry.indexBufferOffset,
+                    boundIndexType = geometry.indexType,
+                    lastStatistics.indexBufferBindCount++;
+                uint32_t firstInstance = instanceDataSize ? uint32_t(i) : 0;
+                if (geometry.indexBuffer)
+                    vkCmdDrawIndexed(commandBuffer, geometry.count, instanceCount, geometry.first, geometry.vertexOffset, firstInstance);
+                else
+                    vkCmdDraw(commandBuffer, geometry.count, instanceCount, geometry.first, firstInstance);
+                lastStatistics.drawCallCount++;
+                i += instanceCount;
+            }
+            Clear();
+            return VK_SUCCESS;
+        }
+        void Clear() {
+            draws.clear();
+            instanceData.clear();
+            entries.clear();
+            pipelineIds.clear();
+            descriptorSetIds.clear();
+            vertexBufferIds.clear();
+            geometryIds.clear();
+            geometryCounts.clear();
+        }
+        void Create(sortMode mode, uint32_t instanceDataSize = 0, uint32_t instanceBinding = 1) {
+            Clear();
+            this->mode = mode;
+            this->instanceDataSize = instanceDataSize;
+            this->instanceBinding = instanceBinding;
         }
     };
 }
@@ -2,18 +2,37 @@
 #include "EasyVulkan.hpp"
 using namespace vulkan;
 
+// 三角形的顶点, 每帧写入上传环形缓冲区
+struct vertex {
+	glm::vec2 position;
+	glm::vec3 color;
+};
+
 pipelineLayout pipelineLayout_triangle; // 管线布局
 pipeline pipeline_triangle; // 管线
 
+// 物体排列成gridSize*gridSize的网格，布满[-4, 4]的区域，视野为其中随时间平移的[-1, 1]的区域，视野外的物体在GPU上被剔除
+constexpr uint32_t gridSize = 256;
+
 // 调用easyVulkan::CreateRpwf_Screen()并存储返回的引用到静态变量，避免重复调用easyVulkan::CreateRpwf_Screen()
 const auto& RenderPassAndFramebuffers() {
 	static const auto& rpwf_screen = easyVulkan::CreateRpwf_Screen();
 	return rpwf_screen;
 }
 
+// 设备支持动态渲染时直接渲染到交换链图像视图，不创建渲染通道，交换链重建时也无需重建帧缓冲
+bool UseDynamicRendering() {
+	return graphicsBase::Base().CmdBeginRendering() != nullptr;
+}
+
 // 创建管线布局
 void CreateLayout() {
-	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+	// 观察投影矩阵以push constant传入顶点着色器
+	VkPushConstantRange pushConstantRange = { VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4) };
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
+		.pushConstantRangeCount = 1,
+		.pPushConstantRanges = &pushConstantRange
+	};
 	pipelineLayout_triangle.Create(pipelineLayoutCreateInfo);
 }
 
@@ -32,8 +51,18 @@ void CreatePipeline() {
 		// 图形管线创建信息
 		graphicsPipelineCreateInfoPack pipelineCiPack;
 		pipelineCiPack.createInfo.layout = pipelineLayout_triangle;
-		pipelineCiPack.createInfo.renderPass = RenderPassAndFramebuffers().renderPass;
-		pipelineCiPack.inputAssemblyStateCi.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+		// 动态渲染时管线不依赖渲染通道，以附件格式代替
+		if (UseDynamicRendering())
+			pipelineCiPack.colorAttachmentFormats.push_back(graphicsBase::Base().SwapchainCreateInfo().imageFormat);
+		else
+			pipelineCiPack.createInfo.renderPass = RenderPassAndFramebuffers().renderPass;
+		pipelineCiPack.vertexInputBindings.emplace_back(0, uint32_t(sizeof(vertex)), VK_VERTEX_INPUT_RATE_VERTEX);
+		pipelineCiPack.vertexInputAttributes.emplace_back(0, 0, VK_FORMAT_R32G32_SFLOAT, uint32_t(offsetof(vertex, position)));
+		pipelineCiPack.vertexInputAttributes.emplace_back(1, 0, VK_FORMAT_R32G32B32_SFLOAT, uint32_t(offsetof(vertex, color)));
+		// 各物体的包围球作为逐实例的顶点属性，间接绘制命令的firstInstance为物体索引
+		pipelineCiPack.vertexInputBindings.emplace_back(1, uint32_t(sizeof(indirectDrawCuller::objectBounds)), VK_VERTEX_INPUT_RATE_INSTANCE);
+		pipelineCiPack.vertexInputAttributes.emplace_back(2, 1, VK_FORMAT_R32G32B32A32_SFLOAT, 0);
+		pipelineCiPack.inputAssemblyStateCi.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
 		pipelineCiPack.viewports.emplace_back(0.f, 0.f, float(windowSize.width), float(windowSize.height), 0.f, 1.f);
 		pipelineCiPack.scissors.emplace_back(VkOffset2D{}, windowSize);
 		pipelineCiPack.multisampleStateCi.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
@@ -44,8 +73,9 @@ void CreatePipeline() {
 		pipeline_triangle.Create(pipelineCiPack);
 		};
 
+	// 管线可能仍被先前的帧所使用，延迟到这些帧执行完毕后销毁，而不必等待设备闲置
 	auto Destroy = [] {
-		pipeline_triangle.~pipeline();
+		pipeline_triangle.DeferDestroy();
 		};
 
 	graphicsBase::Base().PushCallback_CreateSwapchain(Create);
@@ -55,49 +85,204 @@ void CreatePipeline() {
 	Create();
 }
 
-int main() {
-	if (!InitializeWindow({ 1280, 720 }))
+int main(int argc, char** argv) {
+	// 命令行参数的顺序不限
+	auto HasArgument = [argc, argv](const char* argument) {
+		for (int i = 1; i < argc; i++)
+			if (!strcmp(argv[i], argument))
+				return true;
+		return false;
+		};
+	// 以--headless启动时不创建窗口，渲染到离屏图像，用于在没有显示器的机器上测试吞吐量
+	bool headless = HasArgument("--headless");
+	// 以--static启动时，场景每秒才变化一次，各交换链图像的命令缓冲区在场景变化后录制一次，其余各帧直接提交先前的录制，每帧的CPU开销仅余获取、提交和呈现
+	bool staticScene = HasArgument("--static");
+	if (!(headless ?
+		InitializeHeadless({ 1280, 720 }) :
+		InitializeWindow({ 1280, 720 })))
 		return -1;
 
-	const auto& [renderPass, framebuffers] = RenderPassAndFramebuffers();
+	// 任务调度器供流送、并行录制等共用，首次调用Default()的线程被视作主线程，须在此处（GLFW的线程）首先调用
+	jobSystem::Default();
+	// 管线缓存在程序退出时写回磁盘，下次启动时不必重新编译管线
+	easyVulkan::UsePersistentPipelineCache("pipelineCache.bin");
+	// 显存用量越过阈值时发出警告，流送系统可在此减少驻留的资源
+	graphicsBase::Base().PushCallback_MemoryWatermark([](uint32_t heapIndex, float watermark, bool exceeded) {
+		std::cout << std::format("Memory heap {} usage {} {:.0f}% of the budget\n", heapIndex, exceeded ? "exceeded" : "dropped below", watermark * 100);
+		});
 	CreateLayout();
 	CreatePipeline();
 
-	fence fence(VK_FENCE_CREATE_SIGNALED_BIT); // 以置位状态初始化一个栅栏, 在渲染完成后被置位, 开始录制命令缓冲区前需要在CPU一侧手动等待fence被置位以确保先前的命令已完成执行
-	semaphore semaphore_imageIsAvailable; // 
-	semaphore semaphore_renderingIsOver; // 在渲染完成后被置位, 在呈现图像前等待它
+	// 即时帧（frames in flight）：每个槽位有一套专用的栅栏、信号量和命令缓冲区，CPU录制当前帧的同时GPU可以执行先前的帧
+	// 交换链图像被哪个槽位占用由frameContext记录，槽位数与交换链图像数不必相同
+	easyVulkan::frameContext<2> frameContext;
+	// GPU时间戳分析器的查询池与帧上下文的槽位一同轮换，读回结果时不会阻塞
+	gpuProfiler gpuProfiler(frameContext.FrameCount());
+	// 逐帧的上传环形缓冲区，每个槽位一个区域，每帧的顶点等动态数据从中分配，无需逐次映射或分配内存
+	uploadRing uploadRing(65536, frameContext.FrameCount());
+	// CPU一侧各阶段的耗时直方图，以--dump启动时每5秒将统计结果追加到CSV文件
+	frameInstrumentation instrumentation;
+	if (HasArgument("--dump"))
+		instrumentation.EnablePeriodicDump("frameStatistics.csv", std::chrono::seconds(5));
 
-	commandBuffer commandBuffer;
-	commandPool commandPool(graphicsBase::Base().QueueFamilyIndex_Graphics(), VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT); // 从命令池中分配的命令缓冲区可以被重置，从而支持多次向同一命令缓冲区录制命令
-	commandPool.AllocateBuffers(commandBuffer);
+	// GPU驱动的绘制：计算着色器剔除视野外的物体并生成间接绘制命令，绘制的CPU开销与物体数量无关
+	indirectDrawCuller culler;
+	if (culler.Create() ||
+		culler.SetObjectCount(gridSize * gridSize))
+		return -1;
+	// 所有物体共用同一个三角形的索引，物体数据和索引经异步上传引擎上传一次
+	buffer indexBuffer(3 * sizeof(uint16_t), VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	// 静态场景中不旋转的三角形的顶点，预录制的命令缓冲区不能引用逐帧轮换的上传环形缓冲区
+	buffer staticVertexBuffer(3 * sizeof(vertex), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	asyncUploader uploader;
+	{
+		std::vector<indirectDrawCuller::objectBounds> objectBounds(gridSize * gridSize);
+		std::vector<indirectDrawCuller::drawParameters> drawParameters(gridSize * gridSize, { 3, 0, 0 });
+		constexpr float cellSize = 8.f / gridSize;
+		// 包围球的半径即顶点着色器中三角形的缩放倍数，三角形的顶点到原点的距离不超过0.65，必在包围球内
+		for (uint32_t y = 0; y < gridSize; y++)
+			for (uint32_t x = 0; x < gridSize; x++)
+				objectBounds[y * gridSize + x] = { { -4.f + (x + .5f) * cellSize, -4.f + (y + .5f) * cellSize, 0.f }, cellSize * .5f };
+		uint16_t indices[3] = { 0, 1, 2 };
+		vertex staticVertices[3] = {
+			{ { 0.f, -.5f }, { 1, 0, 0 } },
+			{ { .4f, .5f }, { 0, 1, 0 } },
+			{ { -.4f, .5f }, { 0, 0, 1 } }
+		};
+		if (uploader.UploadBuffer(culler.ObjectBoundsBuffer(), objectBounds.data(), objectBounds.size() * sizeof objectBounds[0], 0,
+				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT) ||
+			uploader.UploadBuffer(culler.DrawParametersBuffer(), drawParameters.data(), drawParameters.size() * sizeof drawParameters[0], 0,
+				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT) ||
+			uploader.UploadBuffer(indexBuffer, indices, sizeof indices, 0,
+				VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT) ||
+			uploader.UploadBuffer(staticVertexBuffer, staticVertices, sizeof staticVertices, 0,
+				VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT) ||
+			uploader.Submit() ||
+			uploader.WaitIdle())
+			return -1;
+	}
 
 	VkClearValue clearColor = { .color = { 0.f, 0.f, 0.f, 0.f } };
 
-	// 在当前渲染循环代码中，每一帧所用的同步对象是相同的，这意味着必须渲染完上一帧才能渲染当前帧
-	// 通过给交换链中的每张图像创建一套专用的同步对象、命令缓冲区、帧缓冲，以及其他一切在循环的单帧中会被更新、写入的Vulkan对象，以此在渲染每一帧图像的过程中避免资源竞争，减少阻塞，这种做法叫做即时帧（frames in flight）
-	while (!glfwWindowShouldClose(pWindow)) {
-		// 出于节省CPU和GPU占用的考量，有必要在窗口最小化时阻塞渲染循环
-		while (glfwGetWindowAttrib(pWindow, GLFW_ICONIFIED))
-			glfwWaitEvents();
-		TitleFps();
+	// 视野绕原点平移
+	auto ViewProjection = [](float time) {
+		return glm::translate(glm::mat4(1.f), glm::vec3(-2.5f * std::cos(time * .2f), -2.5f * std::sin(time * .2f), 0.f));
+		};
+	// 在渲染通道中（或以动态渲染）绘制剔除后的物体，逐帧录制与预录制共用
+	auto CmdDrawScene = [&](VkCommandBuffer commandBuffer, uint32_t imageIndex, VkBuffer vertexBuffer, VkDeviceSize vertexBufferOffset, const glm::mat4& viewProjection) {
+		if (UseDynamicRendering())
+			easyVulkan::CmdBeginRendering_Screen(commandBuffer, imageIndex, clearColor.color);
+		else
+			RenderPassAndFramebuffers().renderPass.CmdBegin(commandBuffer, RenderPassAndFramebuffers().framebuffers[imageIndex], { {}, windowSize }, clearColor);
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_triangle);
+		VkBuffer vertexBuffers[2] = { vertexBuffer, culler.ObjectBoundsBuffer() };
+		VkDeviceSize offsets[2] = { vertexBufferOffset, 0 };
+		vkCmdBindVertexBuffers(commandBuffer, 0, 2, vertexBuffers, offsets);
+		vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT16);
+		vkCmdPushConstants(commandBuffer, pipelineLayout_triangle, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof viewProjection, &viewProjection);
+		culler.CmdDraw(commandBuffer);
+		if (UseDynamicRendering())
+			easyVulkan::CmdEndRendering_Screen(commandBuffer, imageIndex);
+		else
+			RenderPassAndFramebuffers().renderPass.CmdEnd(commandBuffer);
+		};
+	// 静态场景的预录制，交换链重建时自动失效，场景变化时手动使之失效
+	glm::mat4 sceneViewProjection(1.f);
+	int64_t sceneSecond = -1;
+	easyVulkan::staticCommandBuffers staticContent(VK_COMMAND_BUFFER_LEVEL_PRIMARY, [&](VkCommandBuffer commandBuffer, uint32_t imageIndex) {
+		culler.CmdCull(commandBuffer, sceneViewProjection);
+		CmdDrawScene(commandBuffer, imageIndex, staticVertexBuffer, 0, sceneViewProjection);
+		});
+
+	// 无窗口时渲染固定的帧数
+	constexpr uint32_t headlessFrameCount = 1000;
+	auto time0 = std::chrono::steady_clock::now();
+	for (uint32_t frameCount = 0; headless ? frameCount < headlessFrameCount : !glfwWindowShouldClose(pWindow); frameCount++) {
+		if (!headless) {
+			// 出于节省CPU和GPU占用的考量，有必要在窗口最小化时阻塞渲染循环
+			while (glfwGetWindowAttrib(pWindow, GLFW_ICONIFIED))
+				glfwWaitEvents();
+			TitleFps(instrumentation);
+		}
+		instrumentation.BeginFrame();
 
-		fence.WaitAndReset();
-		graphicsBase::Base().SwapImage(semaphore_imageIsAvailable);
+		// 等待当前槽位先前的命令执行完毕，然后获取交换链图像
+		{
+			auto measure = instrumentation.Measure(frameInstrumentation::phase_fenceWait);
+			frameContext.WaitForFrame();
+		}
+		uploadRing.BeginFrame(frameContext.CurrentFrameIndex());
+		{
+			auto measure = instrumentation.Measure(frameInstrumentation::phase_acquire);
+			frameContext.AcquireImage();
+		}
 		auto i = graphicsBase::Base().CurrentImageIndex();
+		auto& commandBuffer = frameContext.CurrentFrame().commandBuffer;
 
-		commandBuffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-		renderPass.CmdBegin(commandBuffer, framebuffers[i], { {}, windowSize }, clearColor);
-		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_triangle);
-		vkCmdDraw(commandBuffer, 3, 1, 0, 0);
-		renderPass.CmdEnd(commandBuffer);
-		commandBuffer.End();
+		VkCommandBuffer commandBufferToSubmit = commandBuffer;
+		{
+			auto measure = instrumentation.Measure(frameInstrumentation::phase_record);
+			float angle = std::chrono::duration<float>(std::chrono::steady_clock::now() - time0).count();
+			// 首帧须获取上传的缓冲区的所有权，仍逐帧录制
+			if (staticScene && frameCount) {
+				if (int64_t second = int64_t(angle); second != sceneSecond)
+					sceneSecond = second,
+					sceneViewProjection = ViewProjection(float(second)),
+					staticContent.Invalidate();
+				commandBufferToSubmit = staticContent.CommandBuffer(i);
+			}
+			else {
+				// 令三角形随时间旋转
+				glm::mat2 rotation = { std::cos(angle), std::sin(angle), -std::sin(angle), std::cos(angle) };
+				vertex vertices[3] = {
+					{ rotation * glm::vec2(0.f, -.5f), { 1, 0, 0 } },
+					{ rotation * glm::vec2(.4f, .5f), { 0, 1, 0 } },
+					{ rotation * glm::vec2(-.4f, .5f), { 0, 0, 1 } }
+				};
+				auto vertexData = uploadRing.Upload(vertices, alignof(vertex));
+				glm::mat4 viewProjection = ViewProjection(angle);
+
+				commandBuffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+				gpuProfiler.CmdBeginFrame(commandBuffer);
+				// 存在专用的数据传送队列族时获取上传的缓冲区的所有权，仅首帧有需要获取的所有权
+				uploader.CmdAcquireOwnership(commandBuffer);
+				{
+					gpuProfiler::scope scope_culling(gpuProfiler, commandBuffer, "culling");
+					culler.CmdCull(commandBuffer, viewProjection);
+				}
+				{
+					gpuProfiler::scope scope_triangle(gpuProfiler, commandBuffer, "triangles");
+					CmdDrawScene(commandBuffer, i, vertexData.buffer, vertexData.offset, viewProjection);
+				}
+				commandBuffer.End();
+			}
+		}
 
 		// 将命令缓冲区提交到图形队列时，最迟可以在VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT阶段等待获取交换链图像索引，渲染结果在该阶段被写入到交换链图像
-		graphicsBase::Base().SubmitCommandBuffer_Graphics(commandBuffer, semaphore_imageIsAvailable, semaphore_renderingIsOver, fence);
-		graphicsBase::Base().PresentImage(semaphore_renderingIsOver);
+		{
+			auto measure = instrumentation.Measure(frameInstrumentation::phase_submit);
+			// 内存非host coherent时，本帧写入的数据在提交前一并刷新
+			uploadRing.Flush();
+			frameContext.Submit(commandBufferToSubmit);
+		}
+		{
+			auto measure = instrumentation.Measure(frameInstrumentation::phase_present);
+			frameContext.Present();
+		}
 
-		glfwPollEvents();
+		if (!headless)
+			glfwPollEvents();
+		// 执行其他线程提交的须在主线程中执行的任务
+		jobSystem::Default().ExecuteMainThreadJobs();
+	}
+	if (headless) {
+		graphicsBase::Base().WaitIdle();
+		std::chrono::duration<double> dt = std::chrono::steady_clock::now() - time0;
+		std::cout << std::format("Rendered {} frames in {:.3f} s, {:.1f} FPS\n", headlessFrameCount, dt.count(), headlessFrameCount / dt.count());
 	}
+	std::cout << instrumentation.Report();
+	std::cout << gpuProfiler.Report();
+	std::cout << graphicsBase::Base().MemoryReport();
 	TerminateWindow();
 	return 0;
 }